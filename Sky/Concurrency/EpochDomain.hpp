@@ -0,0 +1,165 @@
+// The zlib/libpng License
+
+// Copyright (c) 2014 Danny Y., Rapptz
+
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+
+// Permission is granted to anyone to use this software for any purpose, including
+// commercial applications, and to alter it and redistribute it freely, subject to
+// the following restrictions:
+
+// 1. The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software. If you use this software in a product,
+// an acknowledgment in the product documentation would be appreciated but is
+// not required.
+
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef SKY_EPOCHDOMAIN_HPP
+#define SKY_EPOCHDOMAIN_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace sky {
+// Epoch based reclamation. Readers announce the epoch they started in for
+// the duration of a read section, writers retire objects they unlinked
+// and those are only destroyed once every reader that could still see
+// them has left. Entering a read section claims one of a fixed number of
+// announcement slots with a compare-exchange, scanning at most once over
+// them. Readers that find every slot taken announce themselves in an
+// overflow list under the domain's mutex instead, so they briefly
+// contend with writers and with each other.
+class EpochDomain {
+private:
+    static constexpr unsigned slotCount = 64;
+
+    struct alignas(64) Slot {
+        std::atomic<std::uint64_t> epoch;
+    };
+
+    Slot slots[slotCount];
+    std::atomic<std::uint64_t> global;
+    std::mutex mutex;
+    std::vector<std::pair<std::uint64_t, std::function<void()>>> retired;
+    std::multiset<std::uint64_t> overflow;
+
+    // Returns the claimed slot, or slotCount if the reader was put into
+    // overflow with the epoch stored in epoch.
+    unsigned enter(std::uint64_t& epoch) {
+        unsigned start = std::hash<std::thread::id>()(std::this_thread::get_id()) % slotCount;
+
+        for(unsigned i = 0; i < slotCount; ++i) {
+            unsigned index = (start + i) % slotCount;
+            std::uint64_t expected = 0;
+
+            if(slots[index].epoch.compare_exchange_strong(expected, global.load())) {
+                return index;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        epoch = global.load();
+        overflow.insert(epoch);
+        return slotCount;
+    }
+
+    void leave(unsigned index, std::uint64_t epoch) {
+        if(index != slotCount) {
+            slots[index].epoch.store(0);
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        overflow.erase(overflow.find(epoch));
+    }
+public:
+    class Reader {
+    private:
+        EpochDomain* domain;
+        std::uint64_t epoch = 0;
+        unsigned index;
+    public:
+        explicit Reader(EpochDomain& domain): domain(&domain), index(domain.enter(epoch)) {}
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+
+        ~Reader() {
+            domain->leave(index, epoch);
+        }
+    };
+
+    EpochDomain(): global(1) {
+        for(auto&& slot : slots) {
+            slot.epoch.store(0);
+        }
+    }
+
+    EpochDomain(const EpochDomain&) = delete;
+    EpochDomain& operator=(const EpochDomain&) = delete;
+
+    // No reader may be active anymore at this point.
+    ~EpochDomain() {
+        for(auto&& item : retired) {
+            item.second();
+        }
+    }
+
+    // Schedules deleter to run once no reader can observe the unlinked object.
+    // The object must already be unreachable for new readers.
+    template<typename Deleter>
+    void retire(Deleter&& deleter) {
+        std::lock_guard<std::mutex> lock(mutex);
+        retired.emplace_back(global.fetch_add(1), std::forward<Deleter>(deleter));
+    }
+
+    // Runs the deleters of every object no active reader can still see.
+    void collect() {
+        std::vector<std::function<void()>> ready;
+        {
+            // Scanning under the lock guarantees every retired object was
+            // unlinked before the scan, so readers the scan misses can't see it.
+            std::lock_guard<std::mutex> lock(mutex);
+            std::uint64_t oldest = overflow.empty() ? 0 : *overflow.begin();
+
+            for(auto&& slot : slots) {
+                std::uint64_t epoch = slot.epoch.load();
+
+                if(epoch != 0 && (oldest == 0 || epoch < oldest)) {
+                    oldest = epoch;
+                }
+            }
+
+            auto it = retired.begin();
+
+            for(; it != retired.end() && (oldest == 0 || it->first < oldest); ++it) {
+                ready.push_back(std::move(it->second));
+            }
+
+            retired.erase(retired.begin(), it);
+        }
+
+        for(auto&& deleter : ready) {
+            deleter();
+        }
+    }
+
+    size_t getRetiredCount() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return retired.size();
+    }
+};
+} // sky
+
+#endif // SKY_EPOCHDOMAIN_HPP
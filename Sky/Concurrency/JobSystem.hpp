@@ -0,0 +1,290 @@
+// The zlib/libpng License
+
+// Copyright (c) 2014 Danny Y., Rapptz
+
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+
+// Permission is granted to anyone to use this software for any purpose, including
+// commercial applications, and to alter it and redistribute it freely, subject to
+// the following restrictions:
+
+// 1. The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software. If you use this software in a product,
+// an acknowledgment in the product documentation would be appreciated but is
+// not required.
+
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef SKY_JOBSYSTEM_HPP
+#define SKY_JOBSYSTEM_HPP
+
+#include "WorkStealingQueue.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace sky {
+// Counts the jobs that are still outstanding. Jobs can be scheduled to
+// start only once a counter reaches zero, which is how dependencies are
+// expressed. A counter must outlive every job attached to it.
+class JobCounter {
+private:
+    friend class JobSystem;
+    unsigned count = 0;
+    mutable std::mutex mutex;
+    std::vector<std::function<void()>> continuations;
+
+    void increment() {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++count;
+    }
+public:
+    JobCounter() = default;
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    // Once this returns true no job touches the counter anymore,
+    // so it is safe to destroy.
+    bool done() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return count == 0;
+    }
+
+    unsigned getCount() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return count;
+    }
+};
+
+// Fixed pool of worker threads with one work stealing queue each.
+// Threads that are not workers share an extra queue and take part in
+// execution whenever they wait on a counter.
+class JobSystem {
+private:
+    struct Job {
+        std::function<void()> function;
+        JobCounter* counter = nullptr;
+    };
+
+    struct ThreadState {
+        const JobSystem* owner;
+        unsigned index;
+    };
+
+    std::vector<std::unique_ptr<WorkStealingQueue<Job>>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<bool> running;
+    std::atomic<unsigned> pending;
+    std::atomic<unsigned> sleeping;
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+
+    static ThreadState& threadState() {
+        static thread_local ThreadState state = { nullptr, 0 };
+        return state;
+    }
+
+    unsigned currentQueue() const {
+        auto&& state = threadState();
+        return state.owner == this ? state.index : 0;
+    }
+
+    void push(Job job) {
+        queues[currentQueue()]->push(std::move(job));
+        pending.fetch_add(1);
+
+        if(sleeping.load() > 0) {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            wake.notify_one();
+        }
+    }
+
+    bool take(Job& job) {
+        unsigned self = currentQueue();
+
+        if(queues[self]->pop(job)) {
+            return true;
+        }
+
+        for(size_t i = 1; i < queues.size(); ++i) {
+            if(queues[(self + i) % queues.size()]->steal(job)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void finish(JobCounter& counter) {
+        std::vector<std::function<void()>> ready;
+        {
+            std::lock_guard<std::mutex> lock(counter.mutex);
+
+            if(--counter.count != 0) {
+                return;
+            }
+
+            ready.swap(counter.continuations);
+        }
+
+        for(auto&& continuation : ready) {
+            continuation();
+        }
+    }
+
+    void work(unsigned index) {
+        threadState() = ThreadState{ this, index };
+
+        while(running.load()) {
+            if(tryRunOne()) {
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            sleeping.fetch_add(1);
+            wake.wait(lock, [this] { return !running.load() || pending.load() > 0; });
+            sleeping.fetch_sub(1);
+        }
+    }
+public:
+    static unsigned defaultThreadCount() {
+        unsigned cores = std::thread::hardware_concurrency();
+        return cores > 1 ? cores - 1 : 0;
+    }
+
+    // With zero workers every job runs on the thread that waits for it.
+    explicit JobSystem(unsigned threads = defaultThreadCount()): running(true), pending(0), sleeping(0) {
+        for(unsigned i = 0; i <= threads; ++i) {
+            queues.emplace_back(new WorkStealingQueue<Job>());
+        }
+
+        for(unsigned i = 1; i <= threads; ++i) {
+            workers.emplace_back(&JobSystem::work, this, i);
+        }
+    }
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    ~JobSystem() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            running.store(false);
+        }
+
+        wake.notify_all();
+
+        for(auto&& worker : workers) {
+            worker.join();
+        }
+
+        while(tryRunOne()) {}
+    }
+
+    unsigned getWorkerCount() const noexcept {
+        return static_cast<unsigned>(workers.size());
+    }
+
+    // Jobs must not throw.
+    template<typename Callable>
+    void schedule(Callable&& function, JobCounter* counter = nullptr) {
+        if(counter != nullptr) {
+            counter->increment();
+        }
+
+        Job job;
+        job.function = std::forward<Callable>(function);
+        job.counter = counter;
+        push(std::move(job));
+    }
+
+    // Schedules the job once dependency reaches zero.
+    template<typename Callable>
+    void scheduleAfter(JobCounter& dependency, Callable&& function, JobCounter* counter = nullptr) {
+        if(counter != nullptr) {
+            counter->increment();
+        }
+
+        auto job = std::make_shared<Job>();
+        job->function = std::forward<Callable>(function);
+        job->counter = counter;
+
+        std::unique_lock<std::mutex> lock(dependency.mutex);
+
+        if(dependency.count == 0) {
+            lock.unlock();
+            push(std::move(*job));
+            return;
+        }
+
+        dependency.continuations.emplace_back([this, job] {
+            push(std::move(*job));
+        });
+    }
+
+    bool tryRunOne() {
+        Job job;
+
+        if(!take(job)) {
+            return false;
+        }
+
+        pending.fetch_sub(1);
+        job.function();
+
+        if(job.counter != nullptr) {
+            finish(*job.counter);
+        }
+
+        return true;
+    }
+
+    // Runs other jobs on the calling thread until the counter reaches zero.
+    void wait(const JobCounter& counter) {
+        while(!counter.done()) {
+            if(!tryRunOne()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    // Splits [begin, end) into chunks of at most grain elements and calls
+    // function(first, last) for each of them in parallel, returning once
+    // all of them have run.
+    template<typename Callable>
+    void parallelFor(size_t begin, size_t end, Callable&& function, size_t grain = 0) {
+        if(begin >= end) {
+            return;
+        }
+
+        size_t count = end - begin;
+
+        if(grain == 0) {
+            grain = std::max<size_t>(1, count / ((workers.size() + 1) * 4));
+        }
+
+        JobCounter counter;
+
+        for(size_t first = begin + grain; first < end; first += grain) {
+            size_t last = std::min(end, first + grain);
+            schedule([&function, first, last] { function(first, last); }, &counter);
+        }
+
+        function(begin, std::min(end, begin + grain));
+        wait(counter);
+    }
+};
+} // sky
+
+#endif // SKY_JOBSYSTEM_HPP
@@ -0,0 +1,85 @@
+// The zlib/libpng License
+
+// Copyright (c) 2014 Danny Y., Rapptz
+
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+
+// Permission is granted to anyone to use this software for any purpose, including
+// commercial applications, and to alter it and redistribute it freely, subject to
+// the following restrictions:
+
+// 1. The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software. If you use this software in a product,
+// an acknowledgment in the product documentation would be appreciated but is
+// not required.
+
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef SKY_WORKSTEALINGQUEUE_HPP
+#define SKY_WORKSTEALINGQUEUE_HPP
+
+#include <deque>
+#include <mutex>
+#include <utility>
+
+namespace sky {
+// Double ended queue owned by a single worker. The owner pushes and pops
+// at the back (LIFO, cache friendly) while other workers steal from the
+// front (FIFO, oldest and usually largest work first).
+template<typename T>
+class WorkStealingQueue {
+private:
+    std::deque<T> items;
+    mutable std::mutex mutex;
+public:
+    WorkStealingQueue() = default;
+    WorkStealingQueue(const WorkStealingQueue&) = delete;
+    WorkStealingQueue& operator=(const WorkStealingQueue&) = delete;
+
+    void push(T item) {
+        std::lock_guard<std::mutex> lock(mutex);
+        items.push_back(std::move(item));
+    }
+
+    bool pop(T& result) {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if(items.empty()) {
+            return false;
+        }
+
+        result = std::move(items.back());
+        items.pop_back();
+        return true;
+    }
+
+    bool steal(T& result) {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if(items.empty()) {
+            return false;
+        }
+
+        result = std::move(items.front());
+        items.pop_front();
+        return true;
+    }
+
+    bool empty() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return items.empty();
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return items.size();
+    }
+};
+} // sky
+
+#endif // SKY_WORKSTEALINGQUEUE_HPP
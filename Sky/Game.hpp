@@ -25,11 +25,58 @@
 
 #include <SFML/System/Time.hpp>
 #include <SFML/System/Clock.hpp>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+#include "Graphics/RenderStats.hpp"
+#include "Utility/FrameArena.hpp"
+#include "Utility/TaskScheduler.hpp"
 
 namespace sky {
 class Game {
+private:
+    struct UpdateChannel {
+        std::function<void(sf::Time)> callback;
+        sf::Time step;
+        sf::Time accumulator;
+        size_t id;
+        bool removed;
+    };
+
+    std::vector<UpdateChannel> channels;
+    std::vector<UpdateChannel> addedChannels;
+    size_t nextChannelId = 0;
+    bool updatingChannels = false;
+
+    // Callbacks may add and remove channels. Channels added meanwhile start
+    // with the next frame and removed ones are erased once all have run.
+    void updateChannels(sf::Time elapsedTime) {
+        updatingChannels = true;
+
+        for(auto&& channel : channels) {
+            channel.accumulator += elapsedTime;
+
+            while(!channel.removed && channel.accumulator >= channel.step) {
+                channel.callback(channel.step);
+                channel.accumulator -= channel.step;
+            }
+        }
+
+        updatingChannels = false;
+        channels.erase(std::remove_if(channels.begin(), channels.end(), [](const UpdateChannel& channel) {
+            return channel.removed;
+        }), channels.end());
+        std::move(addedChannels.begin(), addedChannels.end(), std::back_inserter(channels));
+        addedChannels.clear();
+    }
 protected:
     sf::Time timePerFrame = sf::seconds(1.f/60.f);
+    sf::Time taskBudget = sf::milliseconds(2);
+    FrameArena frameArena;
+    TaskScheduler tasks;
+    RenderStats renderStats;
     bool running = true;
 public:
     virtual ~Game() = default;
@@ -38,10 +85,99 @@ public:
         timePerFrame = sf::seconds(1.f / limit);
     }
 
+    // Registers an extra fixed rate update driven from run() alongside update().
+    // The callback always receives its own step as the delta time, which is
+    // at least a microsecond. Returns an id that can be passed to
+    // removeUpdateChannel.
+    template<typename Callback>
+    size_t addUpdateChannel(unsigned rate, Callback&& callback) {
+        if(rate == 0) {
+            throw std::invalid_argument("update channel rate must be greater than zero");
+        }
+
+        sf::Time step = std::max(sf::seconds(1.f / rate), sf::microseconds(1));
+        auto&& target = updatingChannels ? addedChannels : channels;
+        target.push_back(UpdateChannel{ std::forward<Callback>(callback), step, sf::Time::Zero, nextChannelId, false });
+        return nextChannelId++;
+    }
+
+    bool removeUpdateChannel(size_t id) {
+        auto matches = [id](const UpdateChannel& channel) {
+            return channel.id == id && !channel.removed;
+        };
+
+        auto added = std::find_if(addedChannels.begin(), addedChannels.end(), matches);
+
+        if(added != addedChannels.end()) {
+            addedChannels.erase(added);
+            return true;
+        }
+
+        auto it = std::find_if(channels.begin(), channels.end(), matches);
+
+        if(it == channels.end()) {
+            return false;
+        }
+
+        if(updatingChannels) {
+            it->removed = true;
+        }
+        else {
+            channels.erase(it);
+        }
+
+        return true;
+    }
+
+    void clearUpdateChannels() {
+        addedChannels.clear();
+
+        if(updatingChannels) {
+            for(auto&& channel : channels) {
+                channel.removed = true;
+            }
+        }
+        else {
+            channels.clear();
+        }
+    }
+
+    // Delays each channel slower than the frame rate by a different number of
+    // frames so that channels sharing a rate don't all tick on the same frame.
+    void staggerUpdateChannels() {
+        sf::Int64 offset = 0;
+
+        for(auto&& channel : channels) {
+            if(channel.step > timePerFrame) {
+                channel.accumulator = -sf::microseconds(offset % channel.step.asMicroseconds());
+                offset += timePerFrame.asMicroseconds();
+            }
+        }
+    }
+
+    // Upper bound on the time spent resuming background tasks per frame.
+    // Tasks never run past the point where the next update is due.
+    void setTaskBudget(sf::Time budget) {
+        taskBudget = budget;
+    }
+
     virtual void render() = 0;
     virtual void process() = 0;
     virtual void update(sf::Time dt) = 0;
 
+    FrameArena& getFrameArena() noexcept {
+        return frameArena;
+    }
+
+    TaskScheduler& getTaskScheduler() noexcept {
+        return tasks;
+    }
+
+    // Filled in by Sky's drawables during render().
+    RenderStats& getRenderStats() noexcept {
+        return renderStats;
+    }
+
     void quit() {
         running = false;
     }
@@ -49,8 +185,10 @@ public:
     virtual int run() {
         sf::Clock clock;
         sf::Time deltaTime = sf::Time::Zero;
+        RenderStats::Current measuring(renderStats);
 
         while(running) {
+            frameArena.flip();
             sf::Time elapsedTime = clock.restart();
             deltaTime += elapsedTime;
             process();
@@ -60,8 +198,17 @@ public:
                 deltaTime -= timePerFrame;
             }
 
+            updateChannels(elapsedTime);
+
+            renderStats.beginFrame();
             render();
+            renderStats.endFrame();
+
+            sf::Time untilNextFrame = timePerFrame - deltaTime - clock.getElapsedTime();
+            tasks.run(untilNextFrame < taskBudget ? untilNextFrame : taskBudget);
         }
+
+        return 0;
     }
 };
 } // sky
@@ -24,7 +24,17 @@
 #define SKY_GRAPHICS_HPP
 
 #include "Graphics/AnimatedSprite.hpp"
+#include "Graphics/AnimationSystem.hpp"
+#include "Graphics/GraphicsResources.hpp"
+#include "Graphics/Preloader.hpp"
+#include "Graphics/RenderQueue.hpp"
+#include "Graphics/RenderStats.hpp"
 #include "Graphics/ResourceCache.hpp"
+#include "Graphics/ShaderAnimation.hpp"
+#include "Graphics/SpatialHash.hpp"
+#include "Graphics/SpriteBatch.hpp"
+#include "Graphics/SpritesheetLoader.hpp"
+#include "Graphics/TextureAtlas.hpp"
 #include "Graphics/TileMap.hpp"
 
 #endif // SKY_GRAPHICS_HPP
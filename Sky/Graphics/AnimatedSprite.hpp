@@ -24,6 +24,7 @@
 #define SKY_ANIMATEDSPRITE_HPP
 
 #include "Animation.hpp"
+#include "RenderStats.hpp"
 #include <SFML/Graphics/Drawable.hpp>
 #include <SFML/Graphics/Transformable.hpp>
 #include <SFML/Graphics/RenderTarget.hpp>
@@ -34,45 +35,54 @@ namespace sky {
 class AnimatedSprite : public sf::Drawable, public sf::Transformable {
 private:
     const Animation* animation = nullptr;
-    const sf::Texture* texture = nullptr;
+    mutable const sf::Texture* texture = nullptr;
     bool looped = true;
     bool paused = false;
     sf::Time delay = sf::seconds(0.1f);
     sf::Time currentTime;
     size_t currentFrame = 0;
-    sf::Vertex vertices[4];
+    mutable sf::Vertex vertices[4];
+    mutable unsigned version = 0;
+
+    void copyQuad(size_t position) const {
+        if(animation != nullptr && position < animation->getSize()) {
+            auto&& quad = animation->getQuad(position);
+
+            for(unsigned i = 0; i < 4; ++i) {
+                vertices[i].position = quad.positions[i];
+                vertices[i].texCoords = quad.texCoords[i];
+            }
+        }
+    }
+
+    // Picks up frames added to or replaced in the animation after it was set.
+    void refresh() const {
+        if(animation != nullptr && animation->getVersion() != version) {
+            version = animation->getVersion();
+            texture = animation->getTexture();
+            copyQuad(currentFrame);
+        }
+    }
 
     virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const {
+        refresh();
+
         if(animation != nullptr && texture != nullptr) {
             states.transform *= getTransform();
             states.texture = texture;
+            RenderStats::Scope scope(RenderStats::Sprites, 4, texture);
             target.draw(vertices, 4, sf::Quads, states);
         }
     }
 public:
     AnimatedSprite() = default;
     explicit AnimatedSprite(const Animation& animation, sf::Time delay = sf::seconds(0.1f)):
-    animation(&animation), texture(animation.getTexture()), delay(delay) {}
+    animation(&animation), texture(animation.getTexture()), delay(delay), version(animation.getVersion()) {
+        setFrame(currentFrame);
+    }
 
     void setFrame(size_t position, bool reset = true) {
-        if(animation != nullptr) {
-            auto&& rect = animation->getFrame(position);
-
-            vertices[0].position = sf::Vector2f(0, 0);
-            vertices[1].position = sf::Vector2f(0, rect.height);
-            vertices[2].position = sf::Vector2f(rect.width, rect.height);
-            vertices[3].position = sf::Vector2f(rect.width, 0);
-
-            float left = static_cast<float>(rect.left) + 0.0001f;
-            float right = left + rect.width;
-            float top = static_cast<float>(rect.top);
-            float bottom = top + rect.height;
-
-            vertices[0].texCoords = sf::Vector2f(left, top);
-            vertices[1].texCoords = sf::Vector2f(left, bottom);
-            vertices[2].texCoords = sf::Vector2f(right, bottom);
-            vertices[3].texCoords = sf::Vector2f(right, top);
-        }
+        copyQuad(position);
 
         if(reset) {
             currentTime = sf::Time::Zero;
@@ -86,6 +96,7 @@ public:
     void setAnimation(const Animation& animation) {
         this->animation = &animation;
         texture = this->animation->getTexture();
+        version = this->animation->getVersion();
         currentFrame = 0;
         setFrame(currentFrame);
     }
@@ -104,6 +115,7 @@ public:
     void stop() {
         paused = true;
         currentFrame = 0;
+        setFrame(currentFrame);
     }
 
     void setLooped(bool looped) {
@@ -127,8 +139,7 @@ public:
     }
 
     sf::FloatRect getLocalBounds() const {
-        auto&& rect = animation->getFrame(currentFrame);
-        return sf::FloatRect(0.0f, 0.0f, rect.width, rect.height);
+        return animation->getBounds(currentFrame);
     }
 
     sf::FloatRect getGlobalBounds() const {
@@ -143,11 +154,14 @@ public:
     }
 
     virtual void update(sf::Time deltaTime) {
+        refresh();
+
         if(!paused && (animation != nullptr)) {
             currentTime += deltaTime;
 
             if(currentTime >= delay) {
                 currentTime = sf::Time::Zero;
+                size_t previous = currentFrame;
 
                 if(currentFrame + 1 < animation->getSize()) {
                     ++currentFrame;
@@ -158,18 +172,28 @@ public:
                         paused = true;
                     }
                 }
+
+                if(currentFrame != previous) {
+                    setFrame(currentFrame, false);
+                }
             }
-            setFrame(currentFrame, false);
         }
     }
 
     const sf::Texture* getTexture() const {
+        refresh();
         return texture;
     }
 
     const Animation* getAnimation() const {
         return animation;
     }
+
+    // The untransformed quad, for batching.
+    const sf::Vertex* getVertices() const {
+        refresh();
+        return vertices;
+    }
 };
 } // sky
 
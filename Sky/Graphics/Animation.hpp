@@ -23,36 +23,90 @@
 #ifndef SKY_ANIMATION_HPP
 #define SKY_ANIMATION_HPP
 
+#include <algorithm>
 #include <vector>
 #include <utility>
 #include <SFML/Graphics/Rect.hpp>
 #include <SFML/Graphics/Texture.hpp>
+#include <SFML/System/Vector2.hpp>
 
 namespace sky {
+// Ready to copy vertex data for one frame, in the order
+// top left, bottom left, bottom right, top right.
+struct FrameQuad {
+    sf::Vector2f positions[4];
+    sf::Vector2f texCoords[4];
+};
+
 class Animation {
 private:
     const sf::Texture* texture = nullptr;
     std::vector<sf::IntRect> frames;
+    std::vector<FrameQuad> quads;
+    std::vector<sf::FloatRect> bounds;
+    unsigned version = 0;
+
+    void addFrameData(const sf::IntRect& rect) {
+        float width = static_cast<float>(rect.width);
+        float height = static_cast<float>(rect.height);
+        float left = static_cast<float>(rect.left) + 0.0001f;
+        float right = left + width;
+        float top = static_cast<float>(rect.top);
+        float bottom = top + height;
+
+        FrameQuad quad;
+        quad.positions[0] = sf::Vector2f(0, 0);
+        quad.positions[1] = sf::Vector2f(0, height);
+        quad.positions[2] = sf::Vector2f(width, height);
+        quad.positions[3] = sf::Vector2f(width, 0);
+        quad.texCoords[0] = sf::Vector2f(left, top);
+        quad.texCoords[1] = sf::Vector2f(left, bottom);
+        quad.texCoords[2] = sf::Vector2f(right, bottom);
+        quad.texCoords[3] = sf::Vector2f(right, top);
+        quads.push_back(quad);
+        bounds.emplace_back(0.f, 0.f, width, height);
+        ++version;
+    }
 public:
     Animation() = default;
 
     Animation(const sf::Texture& texture): texture(&texture) {}
 
+    Animation(const Animation&) = default;
+    Animation(Animation&&) = default;
+
+    // Assigning counts as a change, e.g. TextureAtlas::remap.
+    Animation& operator=(Animation other) {
+        unsigned next = std::max(version, other.version) + 1;
+        texture = other.texture;
+        frames.swap(other.frames);
+        quads.swap(other.quads);
+        bounds.swap(other.bounds);
+        version = next;
+        return *this;
+    }
+
     void setTexture(const sf::Texture& texture) {
         this->texture = &texture;
+        ++version;
     }
 
     void addFrame(sf::IntRect frame) {
         frames.emplace_back(std::move(frame));
+        addFrameData(frames.back());
     }
 
     void addFrame(int x, int y, int width, int height) {
-        frames.emplace_back(x, y, width, height);
+        addFrame(sf::IntRect(x, y, width, height));
     }
 
     void addFrames(size_t count, int x, int y, int width, int height) {
+        frames.reserve(frames.size() + count);
+        quads.reserve(quads.size() + count);
+        bounds.reserve(bounds.size() + count);
+
         for(size_t i = 0; i < count; ++i) {
-            frames.emplace_back(x, y, width, height);
+            addFrame(x, y, width, height);
             x += width;
         }
     }
@@ -65,9 +119,24 @@ public:
         return frames[index];
     }
 
+    // Computed once when the frame is added and shared by every sprite.
+    const FrameQuad& getQuad(size_t index) const {
+        return quads[index];
+    }
+
+    const sf::FloatRect& getBounds(size_t index) const {
+        return bounds[index];
+    }
+
     size_t getSize() const {
         return frames.size();
     }
+
+    // Changes whenever the texture or the frames do, so
+    // sprites know when to copy their quad again.
+    unsigned getVersion() const {
+        return version;
+    }
 };
 } // sky
 
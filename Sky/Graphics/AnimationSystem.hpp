@@ -0,0 +1,290 @@
+// The zlib/libpng License
+
+// Copyright (c) 2014 Danny Y., Rapptz
+
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+
+// Permission is granted to anyone to use this software for any purpose, including
+// commercial applications, and to alter it and redistribute it freely, subject to
+// the following restrictions:
+
+// 1. The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software. If you use this software in a product,
+// an acknowledgment in the product documentation would be appreciated but is
+// not required.
+
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef SKY_ANIMATIONSYSTEM_HPP
+#define SKY_ANIMATIONSYSTEM_HPP
+
+#include "Animation.hpp"
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/Vertex.hpp>
+#include <SFML/System/Time.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace sky {
+// Advances many animations at once. The state of every instance is kept in
+// parallel arrays so update() is a tight loop over plain floats, and quads
+// are only rewritten for instances whose frame actually changed.
+// The quads are untransformed, feed them to a SpriteBatch to draw them.
+class AnimationSystem {
+public:
+    using Id = std::uint32_t;
+private:
+    static constexpr Id none = 0xFFFFFFFF;
+
+    // Indexed by dense position.
+    std::vector<float> times;
+    std::vector<float> delays;
+    // 1 while playing and 0 while paused, so update() can multiply by it.
+    std::vector<float> running;
+    std::vector<std::uint32_t> frames;
+    std::vector<unsigned char> looped;
+    std::vector<const Animation*> animations;
+    std::vector<sf::Vertex> vertices;
+    std::vector<Id> ids;
+
+    // Indexed by Id.
+    std::vector<std::uint32_t> positions;
+    std::vector<Id> freeIds;
+
+    std::vector<Id> changed;
+
+    std::uint32_t dense(Id id) const {
+        if(id >= positions.size() || positions[id] == none) {
+            throw std::out_of_range("AnimationSystem has no such instance");
+        }
+
+        return positions[id];
+    }
+
+    void writeQuad(std::uint32_t position) {
+        auto&& animation = *animations[position];
+
+        if(frames[position] >= animation.getSize()) {
+            return;
+        }
+
+        auto&& frame = animation.getQuad(frames[position]);
+        sf::Vertex* quad = &vertices[position * 4];
+
+        for(unsigned i = 0; i < 4; ++i) {
+            quad[i].position = frame.positions[i];
+            quad[i].texCoords = frame.texCoords[i];
+        }
+    }
+
+    // Called for the instances whose delay ran out, which are the minority.
+    void advance(std::uint32_t position) {
+        times[position] = 0.f;
+        std::uint32_t previous = frames[position];
+
+        if(frames[position] + 1 < animations[position]->getSize()) {
+            ++frames[position];
+        }
+        else {
+            frames[position] = 0;
+
+            if(!looped[position]) {
+                running[position] = 0.f;
+            }
+        }
+
+        if(frames[position] != previous) {
+            writeQuad(position);
+            changed.push_back(ids[position]);
+        }
+    }
+public:
+    AnimationSystem() = default;
+
+    void reserve(size_t count) {
+        times.reserve(count);
+        delays.reserve(count);
+        running.reserve(count);
+        frames.reserve(count);
+        looped.reserve(count);
+        animations.reserve(count);
+        vertices.reserve(count * 4);
+        ids.reserve(count);
+    }
+
+    // The quad is copied from the animation whenever the frame changes.
+    // Call setFrame to pick up frames the animation gained or replaced since.
+    Id add(const Animation& animation, sf::Time delay = sf::seconds(0.1f), bool loop = true) {
+        Id id;
+
+        if(!freeIds.empty()) {
+            id = freeIds.back();
+            freeIds.pop_back();
+        }
+        else {
+            id = static_cast<Id>(positions.size());
+            positions.push_back(static_cast<std::uint32_t>(none));
+        }
+
+        std::uint32_t position = static_cast<std::uint32_t>(ids.size());
+        positions[id] = position;
+        times.push_back(0.f);
+        delays.push_back(delay.asSeconds());
+        running.push_back(1.f);
+        frames.push_back(0);
+        looped.push_back(loop);
+        animations.push_back(&animation);
+        vertices.resize(vertices.size() + 4);
+        ids.push_back(id);
+        writeQuad(position);
+        return id;
+    }
+
+    // Moves the last instance into the removed one's place.
+    void remove(Id id) {
+        std::uint32_t position = dense(id);
+        std::uint32_t last = static_cast<std::uint32_t>(ids.size() - 1);
+
+        if(position != last) {
+            times[position] = times[last];
+            delays[position] = delays[last];
+            running[position] = running[last];
+            frames[position] = frames[last];
+            looped[position] = looped[last];
+            animations[position] = animations[last];
+            std::copy(&vertices[last * 4], &vertices[last * 4] + 4, &vertices[position * 4]);
+            ids[position] = ids[last];
+            positions[ids[position]] = position;
+        }
+
+        times.pop_back();
+        delays.pop_back();
+        running.pop_back();
+        frames.pop_back();
+        looped.pop_back();
+        animations.pop_back();
+        vertices.resize(vertices.size() - 4);
+        ids.pop_back();
+        positions[id] = none;
+        freeIds.push_back(id);
+    }
+
+    bool contains(Id id) const noexcept {
+        return id < positions.size() && positions[id] != none;
+    }
+
+    void clear() {
+        times.clear();
+        delays.clear();
+        running.clear();
+        frames.clear();
+        looped.clear();
+        animations.clear();
+        vertices.clear();
+        ids.clear();
+        positions.clear();
+        freeIds.clear();
+        changed.clear();
+    }
+
+    size_t getSize() const noexcept {
+        return ids.size();
+    }
+
+    void update(sf::Time deltaTime) {
+        changed.clear();
+        const float step = deltaTime.asSeconds();
+        const size_t count = times.size();
+        float* time = times.data();
+        const float* playing = running.data();
+
+        // Paused instances multiply their step by zero, which keeps this loop branch free.
+        for(size_t i = 0; i < count; ++i) {
+            time[i] += step * playing[i];
+        }
+
+        for(size_t i = 0; i < count; ++i) {
+            if(time[i] >= delays[i] && playing[i] != 0.f) {
+                advance(static_cast<std::uint32_t>(i));
+            }
+        }
+    }
+
+    // Instances whose quad was rewritten by the last update().
+    const std::vector<Id>& getChanged() const noexcept {
+        return changed;
+    }
+
+    void play(Id id) {
+        std::uint32_t position = dense(id);
+
+        if(running[position] == 0.f) {
+            times[position] = 0.f;
+            running[position] = 1.f;
+        }
+    }
+
+    void pause(Id id) {
+        running[dense(id)] = 0.f;
+    }
+
+    void stop(Id id) {
+        std::uint32_t position = dense(id);
+        running[position] = 0.f;
+        frames[position] = 0;
+        writeQuad(position);
+    }
+
+    bool isPlaying(Id id) const {
+        return running[dense(id)] != 0.f;
+    }
+
+    void setFrame(Id id, size_t frame) {
+        std::uint32_t position = dense(id);
+        frames[position] = static_cast<std::uint32_t>(frame);
+        times[position] = 0.f;
+        writeQuad(position);
+    }
+
+    size_t getFrame(Id id) const {
+        return frames[dense(id)];
+    }
+
+    void setLooped(Id id, bool loop) {
+        looped[dense(id)] = loop;
+    }
+
+    void setDelay(Id id, sf::Time delay) {
+        delays[dense(id)] = delay.asSeconds();
+    }
+
+    void setColor(Id id, const sf::Color& color) {
+        sf::Vertex* quad = &vertices[dense(id) * 4];
+
+        for(unsigned i = 0; i < 4; ++i) {
+            quad[i].color = color;
+        }
+    }
+
+    const Animation* getAnimation(Id id) const {
+        return animations[dense(id)];
+    }
+
+    const sf::Texture* getTexture(Id id) const {
+        return animations[dense(id)]->getTexture();
+    }
+
+    const sf::Vertex* getVertices(Id id) const {
+        return &vertices[dense(id) * 4];
+    }
+};
+} // sky
+
+#endif // SKY_ANIMATIONSYSTEM_HPP
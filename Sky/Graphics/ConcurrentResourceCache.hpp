@@ -0,0 +1,232 @@
+// The zlib/libpng License
+
+// Copyright (c) 2014 Danny Y., Rapptz
+
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+
+// Permission is granted to anyone to use this software for any purpose, including
+// commercial applications, and to alter it and redistribute it freely, subject to
+// the following restrictions:
+
+// 1. The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software. If you use this software in a product,
+// an acknowledgment in the product documentation would be appreciated but is
+// not required.
+
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef SKY_CONCURRENTRESOURCECACHE_HPP
+#define SKY_CONCURRENTRESOURCECACHE_HPP
+
+#include "ResourceKey.hpp"
+#include "../Concurrency/EpochDomain.hpp"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace sky {
+// ResourceCache variant that any number of threads can read from while
+// another inserts or releases. Readers work on an immutable snapshot of
+// the index and only take a lock when more threads read at once than
+// EpochDomain has announcement slots for. Writers are serialised, copy the
+// snapshot, modify and publish the copy, and the old snapshot is
+// reclaimed once no reader can still be using it.
+template<class Key, class Resource>
+class ConcurrentResourceCache {
+public:
+    using Lookup = typename ResourceKey<Key>::Lookup;
+private:
+    using Traits = ResourceKey<Key>;
+
+    struct Identity {
+        size_t operator()(size_t hash) const noexcept {
+            return hash;
+        }
+    };
+
+    struct Item {
+        Key key;
+        std::shared_ptr<Resource> resource;
+    };
+
+    using Snapshot = std::unordered_multimap<size_t, Item, Identity>;
+
+    std::atomic<const Snapshot*> current;
+    EpochDomain epochs;
+    std::mutex writer;
+
+    static const Item* find(const Snapshot& snapshot, const Lookup& key, size_t hash) {
+        auto range = snapshot.equal_range(hash);
+
+        for(auto it = range.first; it != range.second; ++it) {
+            if(Traits::equal(it->second.key, key)) {
+                return &it->second;
+            }
+        }
+
+        return nullptr;
+    }
+
+    static bool erase(Snapshot& snapshot, const Lookup& key, size_t hash) {
+        auto range = snapshot.equal_range(hash);
+
+        for(auto it = range.first; it != range.second; ++it) {
+            if(Traits::equal(it->second.key, key)) {
+                snapshot.erase(it);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // Must be called with the writer lock held.
+    void publish(Snapshot* next) {
+        const Snapshot* previous = current.exchange(next);
+        epochs.retire([previous] { delete previous; });
+        epochs.collect();
+    }
+
+    template<typename Maker>
+    void insertWith(const Lookup& key, Maker&& make) {
+        size_t hash = Traits::hash(key);
+        std::lock_guard<std::mutex> lock(writer);
+        const Snapshot& snapshot = *current.load();
+
+        if(find(snapshot, key, hash) != nullptr) {
+            return;
+        }
+
+        std::unique_ptr<Snapshot> next(new Snapshot(snapshot));
+        next->emplace(hash, Item{ Traits::make(key), make() });
+        publish(next.release());
+    }
+public:
+    // Changes made inside batch(). They only become visible to readers,
+    // all at once, when the batch returns.
+    class Batch {
+    private:
+        friend class ConcurrentResourceCache;
+        Snapshot* next;
+
+        explicit Batch(Snapshot& next) noexcept: next(&next) {}
+
+        template<typename Maker>
+        void insertWith(const Lookup& key, Maker&& make) {
+            size_t hash = Traits::hash(key);
+
+            if(find(*next, key, hash) == nullptr) {
+                next->emplace(hash, Item{ Traits::make(key), make() });
+            }
+        }
+    public:
+        template<typename... Args>
+        void insert(const Lookup& key, Args&&... args) {
+            insertWith(key, [&] { return std::make_shared<Resource>(std::forward<Args>(args)...); });
+        }
+
+        void insert(const Lookup& key, std::shared_ptr<Resource> resource) {
+            if(resource) {
+                insertWith(key, [&] { return std::move(resource); });
+            }
+        }
+
+        void release(const Lookup& key) {
+            erase(*next, key, Traits::hash(key));
+        }
+    };
+
+    ConcurrentResourceCache(): current(new Snapshot()) {}
+    ConcurrentResourceCache(const ConcurrentResourceCache&) = delete;
+    ConcurrentResourceCache& operator=(const ConcurrentResourceCache&) = delete;
+
+    ~ConcurrentResourceCache() {
+        delete current.load();
+    }
+
+    // Every single write copies the whole index, which is fine for a
+    // read-mostly cache but makes n separate inserts O(n^2). Bulk loads
+    // should go through batch() instead.
+    template<typename... Args>
+    void insert(const Lookup& key, Args&&... args) {
+        insertWith(key, [&] { return std::make_shared<Resource>(std::forward<Args>(args)...); });
+    }
+
+    void insert(const Lookup& key, std::shared_ptr<Resource> resource) {
+        if(resource) {
+            insertWith(key, [&] { return std::move(resource); });
+        }
+    }
+
+    void release(const Lookup& key) {
+        size_t hash = Traits::hash(key);
+        std::lock_guard<std::mutex> lock(writer);
+        const Snapshot& snapshot = *current.load();
+
+        if(find(snapshot, key, hash) == nullptr) {
+            return;
+        }
+
+        std::unique_ptr<Snapshot> next(new Snapshot(snapshot));
+        erase(*next, key, hash);
+        publish(next.release());
+    }
+
+    // Calls func with a Batch and publishes everything it did as a single
+    // snapshot, so the index is copied once no matter how many writes.
+    template<typename Callable>
+    void batch(Callable&& func) {
+        std::lock_guard<std::mutex> lock(writer);
+        std::unique_ptr<Snapshot> next(new Snapshot(*current.load()));
+        Batch batch(*next);
+        func(batch);
+        publish(next.release());
+    }
+
+    std::shared_ptr<Resource> get(const Lookup& key) {
+        EpochDomain::Reader reader(epochs);
+        const Item* item = find(*current.load(), key, Traits::hash(key));
+        return item != nullptr ? item->resource : nullptr;
+    }
+
+    // Calls func with the resource inside the read section, which avoids
+    // touching the shared reference count. Returns whether the key exists.
+    template<typename Callable>
+    bool visit(const Lookup& key, Callable&& func) {
+        EpochDomain::Reader reader(epochs);
+        const Item* item = find(*current.load(), key, Traits::hash(key));
+
+        if(item == nullptr) {
+            return false;
+        }
+
+        func(static_cast<const Resource&>(*item->resource));
+        return true;
+    }
+
+    bool contains(const Lookup& key) {
+        EpochDomain::Reader reader(epochs);
+        return find(*current.load(), key, Traits::hash(key)) != nullptr;
+    }
+
+    size_t size() {
+        EpochDomain::Reader reader(epochs);
+        return current.load()->size();
+    }
+
+    // Reclaims snapshots that readers have finished with. Writes already do
+    // this, so it only matters after a burst of writes followed by silence.
+    void collect() {
+        epochs.collect();
+    }
+};
+} // sky
+
+#endif // SKY_CONCURRENTRESOURCECACHE_HPP
@@ -0,0 +1,124 @@
+// The zlib/libpng License
+
+// Copyright (c) 2014 Danny Y., Rapptz
+
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+
+// Permission is granted to anyone to use this software for any purpose, including
+// commercial applications, and to alter it and redistribute it freely, subject to
+// the following restrictions:
+
+// 1. The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software. If you use this software in a product,
+// an acknowledgment in the product documentation would be appreciated but is
+// not required.
+
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef SKY_GRAPHICSRESOURCES_HPP
+#define SKY_GRAPHICSRESOURCES_HPP
+
+#include "ResourceLoader.hpp"
+#include "ResourceSize.hpp"
+#include <SFML/Graphics/Font.hpp>
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/Texture.hpp>
+
+namespace sky {
+// ResourceLoader and ResourceSize for SFML's graphics resources. Kept apart
+// from the primary templates so ResourceCache doesn't need SFML Graphics.
+// Include this before the first ResourceCache of these types is used.
+template<>
+struct ResourceLoader<sf::Image> : FileLoader<sf::Image> {};
+
+// Fonts keep reading from the memory they were loaded from, so only
+// uncompressed archive entries can be used and the Archive has to outlive
+// the font.
+template<>
+struct ResourceLoader<sf::Font> : FileLoader<sf::Font> {
+    using FileLoader<sf::Font>::decode;
+
+    static Decoded decode(const ArchiveEntry& entry) {
+        if(!entry || entry.isCompressed()) {
+            return nullptr;
+        }
+
+        Decoded font(new sf::Font());
+
+        if(!font->loadFromMemory(entry.getData(), entry.getSize())) {
+            font.reset();
+        }
+
+        return font;
+    }
+};
+
+// Textures are decoded to an sf::Image off the main thread
+// and only the upload happens in create().
+template<>
+struct ResourceLoader<sf::Texture> {
+    using Decoded = std::unique_ptr<sf::Image>;
+
+    static Decoded decode(const std::string& filename) {
+        return ResourceLoader<sf::Image>::decode(filename);
+    }
+
+    static Decoded decode(const ArchiveEntry& entry) {
+        return ResourceLoader<sf::Image>::decode(entry);
+    }
+
+    static std::shared_ptr<sf::Texture> create(Decoded& decoded) {
+        if(!decoded) {
+            return nullptr;
+        }
+
+        auto texture = std::make_shared<sf::Texture>();
+
+        if(!texture->loadFromImage(*decoded)) {
+            return nullptr;
+        }
+
+        return texture;
+    }
+
+    // Same sized images are uploaded into the existing texture.
+    static bool assign(sf::Texture& target, Decoded& decoded) {
+        if(!decoded) {
+            return false;
+        }
+
+        if(target.getSize() == decoded->getSize()) {
+            target.update(*decoded);
+            return true;
+        }
+
+        return target.loadFromImage(*decoded);
+    }
+};
+
+template<>
+struct DecodesFromMemory<ResourceLoader<sf::Font>> : std::false_type {};
+
+template<>
+struct ResourceSize<sf::Texture> {
+    static size_t get(const sf::Texture& texture) {
+        auto size = texture.getSize();
+        return static_cast<size_t>(size.x) * size.y * 4;
+    }
+};
+
+template<>
+struct ResourceSize<sf::Image> {
+    static size_t get(const sf::Image& image) {
+        auto size = image.getSize();
+        return sizeof(sf::Image) + static_cast<size_t>(size.x) * size.y * 4;
+    }
+};
+} // sky
+
+#endif // SKY_GRAPHICSRESOURCES_HPP
@@ -0,0 +1,256 @@
+// The zlib/libpng License
+
+// Copyright (c) 2014 Danny Y., Rapptz
+
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+
+// Permission is granted to anyone to use this software for any purpose, including
+// commercial applications, and to alter it and redistribute it freely, subject to
+// the following restrictions:
+
+// 1. The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software. If you use this software in a product,
+// an acknowledgment in the product documentation would be appreciated but is
+// not required.
+
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef SKY_PRELOADER_HPP
+#define SKY_PRELOADER_HPP
+
+#include "ResourceCache.hpp"
+#include "../Concurrency/JobSystem.hpp"
+#include <SFML/System/Clock.hpp>
+#include <SFML/System/Time.hpp>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace sky {
+// Loads a batch of resources into one or more ResourceCaches at once.
+// Decoding is spread over the JobSystem and update() finishes the results
+// on the main thread, so a loading screen can keep drawing in between.
+//
+// A manifest is a text file with one resource per line:
+//
+//   # type   key           filename
+//   texture  player        textures/player.png
+//   font     ui            fonts/ui.ttf
+//   map      level1        maps/level1.tmx
+//
+// The filename defaults to the key. Each type has to be bound to a cache
+// with bind() before the manifest is loaded.
+class Preloader {
+public:
+    struct Progress {
+        size_t loaded = 0;
+        size_t failed = 0;
+        size_t total = 0;
+        std::uint64_t loadedBytes = 0;
+        std::uint64_t totalBytes = 0;
+
+        bool done() const noexcept {
+            return loaded + failed == total;
+        }
+
+        // Fraction done, weighted by file size when the sizes are known.
+        float getRatio() const noexcept {
+            if(totalBytes != 0) {
+                return static_cast<float>(loadedBytes) / totalBytes;
+            }
+
+            return total == 0 ? 1.f : static_cast<float>(loaded + failed) / total;
+        }
+    };
+private:
+    enum class Status {
+        Pending,
+        Loaded,
+        Failed
+    };
+
+    struct Item {
+        std::function<Status()> poll;
+        std::uint64_t bytes;
+        std::string name;
+    };
+
+    struct Binding {
+        std::function<void(const std::string&, const std::string&)> request;
+        std::function<size_t(sf::Time)> upload;
+    };
+
+    JobSystem* jobs;
+    std::unordered_map<std::string, Binding> bindings;
+    std::unordered_set<std::string> requested;
+    std::vector<Item> items;
+    Progress progress;
+
+    static std::uint64_t fileSize(const std::string& filename) {
+        std::ifstream in(filename, std::ios::binary | std::ios::ate);
+        return in ? static_cast<std::uint64_t>(in.tellg()) : 0;
+    }
+
+    template<typename Future>
+    static Status status(const Future& future) {
+        if(future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            return Status::Pending;
+        }
+
+        return future.get() ? Status::Loaded : Status::Failed;
+    }
+
+    template<class Key, class Resource>
+    void request(ResourceCache<Key, Resource>& cache, const std::string& type, const std::string& key, const std::string& filename) {
+        // Keys repeated while still loading are only loaded once.
+        std::string name = type + '\0' + key;
+
+        if(!requested.insert(name).second) {
+            return;
+        }
+
+        auto future = cache.insertAsync(*jobs, key, filename);
+        items.push_back(Item{ [future] { return status(future); }, fileSize(filename), std::move(name) });
+        ++progress.total;
+        progress.totalBytes += items.back().bytes;
+    }
+public:
+    explicit Preloader(JobSystem& jobs): jobs(&jobs) {}
+    // Bindings point back at the Preloader that made them.
+    Preloader(const Preloader&) = delete;
+    Preloader(Preloader&&) = delete;
+    Preloader& operator=(const Preloader&) = delete;
+    Preloader& operator=(Preloader&&) = delete;
+
+    // Makes the manifest type name load into cache. The cache
+    // has to outlive the Preloader and its keys have to be constructible
+    // from a std::string.
+    template<class Key, class Resource>
+    Preloader& bind(const std::string& type, ResourceCache<Key, Resource>& cache) {
+        Binding binding;
+        binding.request = [this, &cache, type](const std::string& key, const std::string& filename) {
+            request(cache, type, key, filename);
+        };
+        binding.upload = [&cache](sf::Time budget) {
+            return cache.upload(budget);
+        };
+        bindings[type] = std::move(binding);
+        return *this;
+    }
+
+    // Queues a single resource of a bound type. Returns false if the type is unknown.
+    bool add(const std::string& type, const std::string& key, const std::string& filename) {
+        auto it = bindings.find(type);
+
+        if(it == bindings.end()) {
+            return false;
+        }
+
+        it->second.request(key, filename);
+        return true;
+    }
+
+    bool add(const std::string& type, const std::string& key) {
+        return add(type, key, key);
+    }
+
+    // Queues every resource listed in the manifest. Lines with an unknown
+    // type are skipped and make this return false.
+    bool loadManifest(const std::string& filename) {
+        std::ifstream in(filename);
+
+        if(!in) {
+            return false;
+        }
+
+        bool result = true;
+        std::string line;
+
+        while(std::getline(in, line)) {
+            std::istringstream ss(line);
+            std::string type;
+            std::string key;
+            std::string path;
+
+            if(!(ss >> type >> key) || type[0] == '#') {
+                continue;
+            }
+
+            if(!(ss >> path)) {
+                path = key;
+            }
+
+            result = add(type, key, path) && result;
+        }
+
+        return result;
+    }
+
+    // Finishes decoded resources on the calling thread for at most budget
+    // and returns the progress so far.
+    Progress update(sf::Time budget) {
+        sf::Clock clock;
+
+        for(auto&& binding : bindings) {
+            sf::Time left = budget - clock.getElapsedTime();
+            binding.second.upload(left < sf::Time::Zero ? sf::Time::Zero : left);
+        }
+
+        for(auto it = items.begin(); it != items.end();) {
+            Status current = it->poll();
+
+            if(current == Status::Pending) {
+                ++it;
+                continue;
+            }
+
+            if(current == Status::Loaded) {
+                ++progress.loaded;
+            }
+            else {
+                ++progress.failed;
+            }
+
+            progress.loadedBytes += it->bytes;
+            requested.erase(it->name);
+            it = items.erase(it);
+        }
+
+        return progress;
+    }
+
+    // Blocks until everything queued so far has been loaded,
+    // helping the JobSystem in the meantime.
+    Progress wait() {
+        while(!update(sf::Time::Zero).done()) {
+            if(!jobs->tryRunOne()) {
+                std::this_thread::yield();
+            }
+        }
+
+        return progress;
+    }
+
+    const Progress& getProgress() const noexcept {
+        return progress;
+    }
+
+    bool done() const noexcept {
+        return progress.done();
+    }
+};
+} // sky
+
+#endif // SKY_PRELOADER_HPP
@@ -0,0 +1,280 @@
+// The zlib/libpng License
+
+// Copyright (c) 2014 Danny Y., Rapptz
+
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+
+// Permission is granted to anyone to use this software for any purpose, including
+// commercial applications, and to alter it and redistribute it freely, subject to
+// the following restrictions:
+
+// 1. The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software. If you use this software in a product,
+// an acknowledgment in the product documentation would be appreciated but is
+// not required.
+
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef SKY_RENDERQUEUE_HPP
+#define SKY_RENDERQUEUE_HPP
+
+#include "AnimatedSprite.hpp"
+#include "RenderStats.hpp"
+#include <SFML/Graphics/Drawable.hpp>
+#include <SFML/Graphics/PrimitiveType.hpp>
+#include <SFML/Graphics/RenderStates.hpp>
+#include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/Shader.hpp>
+#include <SFML/Graphics/Texture.hpp>
+#include <SFML/Graphics/Vertex.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+namespace sky {
+// Collects draw commands for a frame, sorts them by a 64 bit key and
+// draws runs of commands that share the same state with one draw call.
+//
+// The default key is laid out as layer (8 bits), texture (16 bits),
+// shader (8 bits) and depth (32 bits) from most to least significant, so
+// within a layer commands are grouped by texture first. Anything that has
+// to be painted in a particular order across textures needs its own layer.
+// Equal keys keep their submission order.
+class RenderQueue {
+private:
+    struct Command {
+        const sf::Texture* texture;
+        const sf::Shader* shader;
+        sf::BlendMode blendMode;
+        sf::PrimitiveType type;
+        const sf::Drawable* drawable;
+        sf::RenderStates states;
+        size_t first;
+        size_t count;
+    };
+
+    std::vector<Command> commands;
+    std::vector<std::uint64_t> keys;
+    std::vector<sf::Vertex> vertices;
+    std::vector<sf::Vertex> merged;
+    std::vector<std::uint32_t> order;
+    std::vector<std::uint32_t> scratch;
+    std::unordered_map<const sf::Texture*, std::uint16_t> textureIds;
+    std::unordered_map<const sf::Shader*, std::uint8_t> shaderIds;
+    size_t drawCount = 0;
+
+    // Lists of independent primitives can be concatenated, strips and fans can't.
+    static bool mergeable(sf::PrimitiveType type) noexcept {
+        return type == sf::Quads || type == sf::Triangles || type == sf::Lines || type == sf::Points;
+    }
+
+    bool sameState(const Command& lhs, const Command& rhs) const {
+        return lhs.drawable == nullptr && rhs.drawable == nullptr && lhs.type == rhs.type && mergeable(lhs.type) &&
+               lhs.texture == rhs.texture && lhs.shader == rhs.shader && lhs.blendMode == rhs.blendMode;
+    }
+
+    template<typename Id, typename T>
+    static Id getId(std::unordered_map<const T*, Id>& ids, const T* value, const char* error) {
+        if(value == nullptr) {
+            return 0;
+        }
+
+        auto it = ids.find(value);
+
+        if(it != ids.end()) {
+            return it->second;
+        }
+
+        if(ids.size() >= std::numeric_limits<Id>::max()) {
+            throw std::length_error(error);
+        }
+
+        return ids.emplace(value, static_cast<Id>(ids.size() + 1)).first->second;
+    }
+
+    // Stable LSD radix sort of the command indices, a byte at a time.
+    // Bytes that are the same for every key are skipped.
+    void sort() {
+        size_t size = keys.size();
+        order.resize(size);
+        scratch.resize(size);
+
+        for(size_t i = 0; i < size; ++i) {
+            order[i] = static_cast<std::uint32_t>(i);
+        }
+
+        for(unsigned shift = 0; shift < 64; shift += 8) {
+            size_t counts[256] = {};
+
+            for(size_t i = 0; i < size; ++i) {
+                ++counts[(keys[i] >> shift) & 0xFF];
+            }
+
+            if(size == 0 || counts[(keys[0] >> shift) & 0xFF] == size) {
+                continue;
+            }
+
+            size_t offset = 0;
+
+            for(auto&& count : counts) {
+                size_t current = count;
+                count = offset;
+                offset += current;
+            }
+
+            for(size_t i = 0; i < size; ++i) {
+                auto index = order[i];
+                scratch[counts[(keys[index] >> shift) & 0xFF]++] = index;
+            }
+
+            order.swap(scratch);
+        }
+    }
+public:
+    RenderQueue() = default;
+
+    void reserve(size_t commandCount, size_t vertexCount) {
+        commands.reserve(commandCount);
+        keys.reserve(commandCount);
+        vertices.reserve(vertexCount);
+    }
+
+    void clear() {
+        commands.clear();
+        keys.clear();
+        vertices.clear();
+        textureIds.clear();
+        shaderIds.clear();
+    }
+
+    // Small per frame ids, in order of first use. Zero is kept for null, so
+    // a frame can use 65535 textures and 255 shaders. Going over throws
+    // std::length_error; flush() more often if that happens.
+    std::uint16_t getTextureId(const sf::Texture* texture) {
+        return getId(textureIds, texture, "RenderQueue is out of texture ids");
+    }
+
+    std::uint8_t getShaderId(const sf::Shader* shader) {
+        return getId(shaderIds, shader, "RenderQueue is out of shader ids");
+    }
+
+    static std::uint64_t makeKey(std::uint8_t layer, std::uint16_t texture, std::uint8_t shader, std::uint32_t depth) noexcept {
+        return (static_cast<std::uint64_t>(layer) << 56) | (static_cast<std::uint64_t>(texture) << 40) |
+               (static_cast<std::uint64_t>(shader) << 32) | depth;
+    }
+
+    std::uint64_t makeKey(std::uint8_t layer, const sf::RenderStates& states, std::uint32_t depth = 0) {
+        return makeKey(layer, getTextureId(states.texture), getShaderId(states.shader), depth);
+    }
+
+    // Copies the vertices with states.transform already applied.
+    void submit(std::uint64_t key, const sf::Vertex* source, size_t count, sf::PrimitiveType type,
+                const sf::RenderStates& states = sf::RenderStates::Default) {
+        size_t first = vertices.size();
+        vertices.insert(vertices.end(), source, source + count);
+
+        for(size_t i = first; i < vertices.size(); ++i) {
+            vertices[i].position = states.transform.transformPoint(vertices[i].position);
+        }
+
+        commands.push_back(Command{ states.texture, states.shader, states.blendMode, type, nullptr, sf::RenderStates(), first, count });
+        keys.push_back(key);
+    }
+
+    void submit(std::uint8_t layer, const sf::Vertex* source, size_t count, sf::PrimitiveType type,
+                const sf::RenderStates& states = sf::RenderStates::Default, std::uint32_t depth = 0) {
+        submit(makeKey(layer, states, depth), source, count, type, states);
+    }
+
+    void submit(std::uint8_t layer, const AnimatedSprite& sprite, std::uint32_t depth = 0) {
+        if(sprite.getAnimation() != nullptr && sprite.getTexture() != nullptr) {
+            sf::RenderStates states(sprite.getTransform());
+            states.texture = sprite.getTexture();
+            submit(layer, sprite.getVertices(), 4, sf::Quads, states, depth);
+        }
+    }
+
+    // Anything else is drawn as is in its sorted position. The drawable
+    // has to stay alive until flush().
+    void submit(std::uint64_t key, const sf::Drawable& drawable, const sf::RenderStates& states = sf::RenderStates::Default) {
+        commands.push_back(Command{ states.texture, states.shader, states.blendMode, sf::Points, &drawable, states, 0, 0 });
+        keys.push_back(key);
+    }
+
+    size_t getCommandCount() const noexcept {
+        return commands.size();
+    }
+
+    // Draw calls issued by the last flush().
+    size_t getDrawCount() const noexcept {
+        return drawCount;
+    }
+
+    // Sorts, draws and clears everything submitted since the last flush.
+    void flush(sf::RenderTarget& target, const sf::RenderStates& states = sf::RenderStates::Default) {
+        sort();
+        drawCount = 0;
+
+        for(size_t i = 0; i < order.size();) {
+            const Command& command = commands[order[i]];
+
+            // Drawables report their own statistics.
+            if(command.drawable != nullptr) {
+                sf::RenderStates combined = command.states;
+                combined.transform = states.transform * combined.transform;
+                target.draw(*command.drawable, combined);
+                ++drawCount;
+                ++i;
+                continue;
+            }
+
+            size_t next = i + 1;
+            size_t total = command.count;
+            bool contiguous = true;
+
+            while(next < order.size() && sameState(command, commands[order[next]])) {
+                const Command& part = commands[order[next]];
+                const Command& previous = commands[order[next - 1]];
+                contiguous = contiguous && part.first == previous.first + previous.count;
+                total += part.count;
+                ++next;
+            }
+
+            sf::RenderStates current(command.blendMode, states.transform, command.texture, command.shader);
+            const sf::Vertex* source = vertices.data() + command.first;
+
+            // Runs submitted in draw order are already adjacent and are drawn
+            // in place. Others are gathered once into the merge buffer.
+            if(!contiguous) {
+                merged.resize(total);
+                auto output = merged.begin();
+
+                for(size_t j = i; j < next; ++j) {
+                    const Command& part = commands[order[j]];
+                    output = std::copy(vertices.begin() + part.first, vertices.begin() + part.first + part.count, output);
+                }
+
+                source = merged.data();
+            }
+
+            RenderStats::Scope scope(RenderStats::Queued, total, command.texture);
+            target.draw(source, total, command.type, current);
+
+            ++drawCount;
+            i = next;
+        }
+
+        clear();
+    }
+};
+} // sky
+
+#endif // SKY_RENDERQUEUE_HPP
@@ -0,0 +1,252 @@
+// The zlib/libpng License
+
+// Copyright (c) 2014 Danny Y., Rapptz
+
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+
+// Permission is granted to anyone to use this software for any purpose, including
+// commercial applications, and to alter it and redistribute it freely, subject to
+// the following restrictions:
+
+// 1. The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software. If you use this software in a product,
+// an acknowledgment in the product documentation would be appreciated but is
+// not required.
+
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef SKY_RENDERSTATS_HPP
+#define SKY_RENDERSTATS_HPP
+
+#include <SFML/System/Time.hpp>
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Circumvent including "unnecessary" dependencies.
+namespace sf {
+class Texture;
+} // sf
+
+namespace sky {
+// Per frame counters of what Sky's drawables submit to the GPU. Drawables
+// report to whichever RenderStats is current on the drawing thread, and
+// nothing is measured while none is. Texture binds are counted whenever a draw uses a
+// different texture than the previous one.
+class RenderStats {
+public:
+    enum Category {
+        Sprites,
+        Tiles,
+        Batches,
+        Queued,
+        CategoryCount
+    };
+
+    struct Counters {
+        std::size_t draws = 0;
+        std::size_t vertices = 0;
+        std::size_t textureBinds = 0;
+        sf::Time time;
+
+        Counters& operator+=(const Counters& other) {
+            draws += other.draws;
+            vertices += other.vertices;
+            textureBinds += other.textureBinds;
+            time += other.time;
+            return *this;
+        }
+    };
+
+    struct Frame {
+        Counters categories[CategoryCount];
+
+        Counters getTotal() const {
+            Counters total;
+
+            for(auto&& counters : categories) {
+                total += counters;
+            }
+
+            return total;
+        }
+
+        // Times are in microseconds.
+        std::string toJSON() const {
+            std::ostringstream out;
+            auto write = [&out](const char* name, const Counters& counters) {
+                out << '"' << name << "\":{\"draws\":" << counters.draws << ",\"vertices\":" << counters.vertices
+                    << ",\"textureBinds\":" << counters.textureBinds << ",\"time\":" << counters.time.asMicroseconds() << '}';
+            };
+
+            out << '{';
+
+            for(int i = 0; i < CategoryCount; ++i) {
+                write(getName(static_cast<Category>(i)), categories[i]);
+                out << ',';
+            }
+
+            write("total", getTotal());
+            out << '}';
+            return out.str();
+        }
+    };
+
+    // Measures one draw from construction to destruction.
+    class Scope {
+    private:
+        RenderStats* stats;
+        Category category;
+        std::size_t vertices;
+        const sf::Texture* texture;
+        std::chrono::steady_clock::time_point start;
+    public:
+        Scope(Category category, std::size_t vertices, const sf::Texture* texture):
+        stats(getCurrent()), category(category), vertices(vertices), texture(texture) {
+            if(stats != nullptr) {
+                start = std::chrono::steady_clock::now();
+            }
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        ~Scope() {
+            if(stats != nullptr) {
+                auto elapsed = std::chrono::steady_clock::now() - start;
+                stats->record(category, vertices, texture,
+                              sf::microseconds(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()));
+            }
+        }
+    };
+
+    // Makes stats current on this thread for its lifetime, then restores
+    // whatever was current before, however the scope is left.
+    class Current {
+    private:
+        RenderStats* previous;
+    public:
+        explicit Current(RenderStats& stats) noexcept: previous(getCurrent()) {
+            setCurrent(&stats);
+        }
+
+        Current(const Current&) = delete;
+        Current& operator=(const Current&) = delete;
+
+        ~Current() {
+            setCurrent(previous);
+        }
+    };
+private:
+    Frame frame;
+    std::vector<Frame> history;
+    std::size_t historyIndex = 0;
+    std::size_t historySize = 0;
+    const sf::Texture* lastTexture = nullptr;
+    std::ostream* log = nullptr;
+
+    static RenderStats*& current() {
+        static thread_local RenderStats* stats = nullptr;
+        return stats;
+    }
+public:
+    explicit RenderStats(std::size_t historyLength = 120): history(historyLength) {}
+
+    // Only stops measuring on the destroying thread. Other threads must
+    // not keep a destroyed RenderStats current.
+    ~RenderStats() {
+        if(getCurrent() == this) {
+            setCurrent(nullptr);
+        }
+    }
+
+    static RenderStats* getCurrent() noexcept {
+        return current();
+    }
+
+    // Drawables on the calling thread report to stats until another one is
+    // made current. Pass null to stop measuring.
+    static void setCurrent(RenderStats* stats) noexcept {
+        current() = stats;
+    }
+
+    static const char* getName(Category category) noexcept {
+        static const char* names[] = { "sprites", "tiles", "batches", "queued" };
+        return category < CategoryCount ? names[category] : "unknown";
+    }
+
+    void record(Category category, std::size_t vertices, const sf::Texture* texture, sf::Time elapsed) {
+        auto&& counters = frame.categories[category];
+        ++counters.draws;
+        counters.vertices += vertices;
+        counters.time += elapsed;
+
+        if(texture != lastTexture) {
+            ++counters.textureBinds;
+            lastTexture = texture;
+        }
+    }
+
+    void beginFrame() {
+        frame = Frame();
+        lastTexture = nullptr;
+    }
+
+    // Stores the frame in the history and writes it to the log, if any.
+    void endFrame() {
+        if(!history.empty()) {
+            history[historyIndex] = frame;
+            historyIndex = (historyIndex + 1) % history.size();
+
+            if(historySize < history.size()) {
+                ++historySize;
+            }
+        }
+
+        if(log != nullptr) {
+            *log << frame.toJSON() << '\n';
+        }
+    }
+
+    // Writes every finished frame as one line of JSON.
+    void setLog(std::ostream* stream) noexcept {
+        log = stream;
+    }
+
+    // The frame in progress.
+    const Frame& getCurrentFrame() const noexcept {
+        return frame;
+    }
+
+    Frame getLastFrame() const {
+        if(historySize == 0) {
+            return Frame();
+        }
+
+        return history[(historyIndex + history.size() - 1) % history.size()];
+    }
+
+    // Oldest first.
+    std::vector<Frame> getHistory() const {
+        std::vector<Frame> result;
+        result.reserve(historySize);
+        std::size_t start = (historyIndex + history.size() - historySize) % (history.empty() ? 1 : history.size());
+
+        for(std::size_t i = 0; i < historySize; ++i) {
+            result.push_back(history[(start + i) % history.size()]);
+        }
+
+        return result;
+    }
+};
+} // sky
+
+#endif // SKY_RENDERSTATS_HPP
@@ -23,47 +23,872 @@
 #ifndef SKY_RESOURCECACHE_HPP
 #define SKY_RESOURCECACHE_HPP
 
+#include "ResourceHandle.hpp"
+#include "ResourceKey.hpp"
+#include "ResourceLoader.hpp"
+#include "ResourceSize.hpp"
+#include "ResourceStats.hpp"
+#include "../Concurrency/JobSystem.hpp"
+#include "../Utility/Archive.hpp"
+#include "../Utility/ContentHash.hpp"
+#include "../Utility/FileWatcher.hpp"
+#include <SFML/System/Clock.hpp>
+#include <SFML/System/Time.hpp>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <cstdint>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 namespace sky {
 template<class Key, class Resource>
 class ResourceCache {
+public:
+    using Loader = ResourceLoader<Resource>;
+    using Lookup = typename ResourceKey<Key>::Lookup;
+    using Future = std::shared_future<std::shared_ptr<Resource>>;
+    using Handle = ResourceHandle<Resource>;
 private:
-    std::unordered_map<Key, std::shared_ptr<Resource>> cache;
+    using Traits = ResourceKey<Key>;
+    using Decoded = typename Loader::Decoded;
+
+    struct Decode {
+        template<typename... Args>
+        Decoded operator()(Args&... args) const {
+            return Loader::decode(args...);
+        }
+    };
+
+    // Filled in by the decode job. Decoding is skipped if the
+    // contents were already resident when the job ran.
+    struct Decoding {
+        Decoded decoded;
+        std::uint64_t content = 0;
+        bool skipped = false;
+    };
+
+    // Resident content hashes, readable from the decode jobs.
+    struct ContentIndex {
+        std::mutex mutex;
+        std::unordered_set<std::uint64_t> hashes;
+    };
+
+    // Decodes a resource and, when given a content index, hashes what it is
+    // loaded from. Files and archive entries are read once and decoded from
+    // the same bytes that were hashed whenever the Loader can decode from
+    // memory. With skip set, decoding is skipped for contents in the index.
+    // Arguments other than a filename or an ArchiveEntry have no content hash.
+    struct LoadContent {
+        static std::uint64_t nonZero(std::uint64_t hash) noexcept {
+            return hash == 0 ? 1 : hash;
+        }
+
+        static bool known(ContentIndex& index, std::uint64_t content) {
+            std::lock_guard<std::mutex> lock(index.mutex);
+            return index.hashes.count(content) != 0;
+        }
+
+        template<typename Fallback>
+        static Decoded fromMemory(const char* data, size_t size, Fallback&, std::true_type) {
+            return Loader::decode(ArchiveEntry(data, size, size, false));
+        }
+
+        template<typename Fallback>
+        static Decoded fromMemory(const char*, size_t, Fallback& fallback, std::false_type) {
+            return fallback();
+        }
+
+        template<typename Fallback>
+        static void hashed(Decoding& result, ContentIndex& index, bool skip, const char* data, size_t size, bool readable, Fallback fallback) {
+            if(!readable) {
+                result.decoded = fallback();
+                return;
+            }
+
+            result.content = nonZero(xxh64(data, size));
+            result.skipped = skip && known(index, result.content);
+
+            if(!result.skipped) {
+                result.decoded = fromMemory(data, size, fallback, DecodesFromMemory<Loader>());
+            }
+        }
+
+        template<typename... Args>
+        void operator()(Decoding& result, ContentIndex*, bool, const Args&... args) const {
+            result.decoded = Loader::decode(args...);
+        }
+
+        void operator()(Decoding& result, ContentIndex* index, bool skip, const std::string& filename) const {
+            if(index == nullptr) {
+                result.decoded = Loader::decode(filename);
+                return;
+            }
+
+            std::ifstream in(filename, std::ios::binary);
+            std::vector<char> bytes;
+
+            if(in) {
+                bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+            }
+
+            hashed(result, *index, skip, bytes.data(), bytes.size(), static_cast<bool>(in), [&filename] {
+                return Loader::decode(filename);
+            });
+        }
+
+        void operator()(Decoding& result, ContentIndex* index, bool skip, const char* filename) const {
+            (*this)(result, index, skip, std::string(filename));
+        }
+
+        void operator()(Decoding& result, ContentIndex* index, bool skip, const ArchiveEntry& entry) const {
+            if(index == nullptr) {
+                result.decoded = Loader::decode(entry);
+                return;
+            }
+
+            std::vector<char> buffer;
+            const char* data = entry ? entry.view(buffer) : nullptr;
+            hashed(result, *index, skip, data, entry.getSize(), data != nullptr, [&entry] {
+                return Loader::decode(entry);
+            });
+        }
+    };
+
+    struct Pending {
+        Key key;
+        JobSystem* jobs;
+        JobCounter decoded;
+        std::shared_ptr<Decoding> result;
+        std::promise<std::shared_ptr<Resource>> promise;
+        Future future;
+        sf::Clock requested;
+        std::function<Decoded()> decode;
+    };
+
+    struct Reload {
+        Key key;
+        JobSystem* jobs;
+        JobCounter decoded;
+        std::shared_ptr<Decoding> result;
+    };
+
+    static constexpr std::uint32_t none = std::numeric_limits<std::uint32_t>::max();
+
+    // Everything about a slot that the hot path doesn't need.
+    // previous and next link the slots into the recently used list.
+    struct Slot {
+        Key key;
+        std::shared_ptr<Resource> resource;
+        size_t hash;
+        size_t bytes;
+        std::uint64_t content;
+        std::uint32_t pins;
+        std::uint32_t previous;
+        std::uint32_t next;
+    };
+
+    // Dense array that handles resolve through.
+    struct Resident {
+        Resource* resource;
+        std::uint32_t generation;
+    };
+
+    // Keys are already hashed by ResourceKey before they reach the maps.
+    struct Identity {
+        size_t operator()(size_t hash) const noexcept {
+            return hash;
+        }
+    };
+
+    // One resource shared by every key whose contents hash the same.
+    // Its bytes are only counted once.
+    struct Content {
+        std::weak_ptr<Resource> resource;
+        std::uint32_t aliases;
+        size_t bytes;
+    };
+
+    using Index = std::unordered_multimap<size_t, std::uint32_t, Identity>;
+    using PendingIndex = std::unordered_multimap<size_t, std::unique_ptr<Pending>, Identity>;
+
+    Index index;
+    PendingIndex pending;
+    std::vector<Slot> slots;
+    std::vector<Resident> resident;
+    std::vector<std::uint32_t> freeSlots;
+    std::uint32_t newest = none;
+    std::uint32_t oldest = none;
+    size_t budget = std::numeric_limits<size_t>::max();
+    size_t residentBytes = 0;
+    std::unique_ptr<FileWatcher> watcher;
+    std::unordered_map<std::string, std::vector<std::pair<Key, JobSystem*>>> watched;
+    std::vector<std::unique_ptr<Reload>> reloads;
+    size_t (ResourceCache::*reloader)(const sf::Clock&, sf::Time, size_t) = nullptr;
+    ResourceStats stats;
+    std::unordered_map<std::uint64_t, Content> contents;
+    std::shared_ptr<ContentIndex> contentIndex;
+
+    std::uint32_t find(const Lookup& key, size_t hash) const {
+        auto range = index.equal_range(hash);
+
+        for(auto it = range.first; it != range.second; ++it) {
+            if(Traits::equal(slots[it->second].key, key)) {
+                return it->second;
+            }
+        }
+
+        return none;
+    }
+
+    typename PendingIndex::iterator findPending(const Lookup& key, size_t hash) {
+        auto range = pending.equal_range(hash);
+
+        for(auto it = range.first; it != range.second; ++it) {
+            if(Traits::equal(it->second->key, key)) {
+                return it;
+            }
+        }
+
+        return pending.end();
+    }
+
+    void link(std::uint32_t position) {
+        Slot& slot = slots[position];
+        slot.previous = none;
+        slot.next = newest;
+
+        if(newest != none) {
+            slots[newest].previous = position;
+        }
+
+        newest = position;
+
+        if(oldest == none) {
+            oldest = position;
+        }
+    }
+
+    void unlink(std::uint32_t position) {
+        Slot& slot = slots[position];
+        (slot.previous != none ? slots[slot.previous].next : newest) = slot.next;
+        (slot.next != none ? slots[slot.next].previous : oldest) = slot.previous;
+    }
+
+    void touch(std::uint32_t position) {
+        if(position != newest) {
+            unlink(position);
+            link(position);
+        }
+    }
+
+    void publish(std::uint64_t content, bool resident) {
+        if(contentIndex) {
+            std::lock_guard<std::mutex> lock(contentIndex->mutex);
+
+            if(resident) {
+                contentIndex->hashes.insert(content);
+            }
+            else {
+                contentIndex->hashes.erase(content);
+            }
+        }
+    }
+
+    std::shared_ptr<Resource> shared(std::uint64_t content) const {
+        auto it = content == 0 ? contents.end() : contents.find(content);
+        return it != contents.end() ? it->second.resource.lock() : nullptr;
+    }
+
+    std::uint32_t owners(const Slot& slot) const {
+        return slot.content == 0 ? 1 : contents.find(slot.content)->second.aliases;
+    }
+
+    std::uint32_t store(size_t hash, Key key, std::shared_ptr<Resource> resource, std::uint64_t content = 0) {
+        std::uint32_t position;
+
+        if(!freeSlots.empty()) {
+            position = freeSlots.back();
+            freeSlots.pop_back();
+        }
+        else {
+            if(slots.size() > Handle::indexMask) {
+                throw std::length_error("ResourceCache is out of slots");
+            }
+
+            position = static_cast<std::uint32_t>(slots.size());
+            slots.push_back(Slot());
+            resident.push_back(Resident{ nullptr, 1 });
+        }
+
+        Slot& slot = slots[position];
+        slot.key = std::move(key);
+        slot.resource = std::move(resource);
+        slot.hash = hash;
+        slot.bytes = ResourceSize<Resource>::get(*slot.resource);
+        slot.content = content;
+        slot.pins = 0;
+        resident[position].resource = slot.resource.get();
+
+        index.emplace(hash, position);
+        link(position);
+        ++stats.inserts;
+
+        if(content == 0) {
+            residentBytes += slot.bytes;
+        }
+        else {
+            auto&& entry = contents[content];
+
+            if(entry.aliases++ == 0) {
+                entry.resource = slot.resource;
+                entry.bytes = slot.bytes;
+                residentBytes += slot.bytes;
+                publish(content, true);
+            }
+        }
+
+        evict(position);
+        return position;
+    }
+
+    void erase(std::uint32_t position) {
+        Slot& slot = slots[position];
+        auto range = index.equal_range(slot.hash);
+
+        for(auto it = range.first; it != range.second; ++it) {
+            if(it->second == position) {
+                index.erase(it);
+                break;
+            }
+        }
+
+        unlink(position);
+        slot.resource.reset();
+
+        if(slot.content == 0) {
+            residentBytes -= slot.bytes;
+        }
+        else {
+            auto it = contents.find(slot.content);
+
+            if(--it->second.aliases == 0) {
+                residentBytes -= it->second.bytes;
+                contents.erase(it);
+                publish(slot.content, false);
+            }
+        }
+
+        auto&& entry = resident[position];
+        entry.resource = nullptr;
+        entry.generation = (entry.generation + 1) & Handle::generationMask;
+
+        if(entry.generation == 0) {
+            entry.generation = 1;
+        }
+
+        freeSlots.push_back(position);
+    }
+
+    // Evicts unpinned entries that nobody outside the cache references,
+    // least recently used first, until the cache fits its budget.
+    // Keys sharing deduplicated contents only count as references of each other.
+    void evict(std::uint32_t keep) {
+        std::uint32_t position = oldest;
+
+        while(residentBytes > budget && position != none) {
+            Slot& slot = slots[position];
+            std::uint32_t previous = slot.previous;
+
+            if(position != keep && slot.pins == 0 && slot.resource.use_count() == owners(slot)) {
+                erase(position);
+                ++stats.evictions;
+            }
+
+            position = previous;
+        }
+    }
+
+    bool valid(Handle handle) const noexcept {
+        return handle.index() < resident.size() && resident[handle.index()].generation == handle.generation() &&
+               resident[handle.index()].resource != nullptr;
+    }
+
+    std::shared_ptr<Resource> finish(size_t hash, Pending& job) {
+        std::uint32_t position = find(job.key, hash);
+        std::shared_ptr<Resource> resource;
+
+        if(position != none) {
+            resource = slots[position].resource;
+        }
+        else {
+            auto&& result = *job.result;
+            resource = shared(result.content);
+
+            if(resource) {
+                ++stats.deduplicated;
+            }
+            else {
+                // The contents were evicted after the job decided to skip them.
+                if(result.skipped) {
+                    result.decoded = job.decode();
+                }
+
+                if(result.decoded) {
+                    resource = Loader::create(result.decoded);
+                }
+            }
+
+            if(resource) {
+                store(hash, job.key, resource, result.content);
+            }
+            else {
+                ++stats.failures;
+            }
+
+            stats.recordLoad(job.requested.getElapsedTime());
+        }
+
+        job.promise.set_value(resource);
+        return resource;
+    }
+
+    void pollChanges() {
+        for(auto&& filename : watcher->poll()) {
+            auto it = watched.find(filename);
+
+            if(it == watched.end()) {
+                continue;
+            }
+
+            for(auto&& entry : it->second) {
+                std::unique_ptr<Reload> reload(new Reload{ entry.first, entry.second, {}, std::make_shared<Decoding>() });
+                auto result = reload->result;
+                auto known = contentIndex;
+                reload->jobs->schedule([result, known, filename] {
+                    LoadContent()(*result, known.get(), false, filename);
+                }, &reload->decoded);
+                reloads.push_back(std::move(reload));
+            }
+        }
+    }
+
+    // Registers the reloaded contents of a slot that no longer shares any.
+    // Contents matching another resident resource stay unshared until the
+    // next load, since that resource may itself be reloaded.
+    void adopt(std::uint32_t position, std::uint64_t content) {
+        Slot& slot = slots[position];
+
+        if(content == 0 || contents.count(content) != 0) {
+            return;
+        }
+
+        slot.content = content;
+        contents[content] = Content{ slot.resource, 1, slot.bytes };
+        publish(content, true);
+    }
+
+    // Swaps the reloaded data into the live resource so every shared_ptr,
+    // handle and raw pointer to it sees the new contents. A key that shares
+    // deduplicated contents with others is split off into a resource of its
+    // own instead, so the other keys keep what they loaded. shared_ptrs
+    // obtained through the reloaded key before the split keep the old data.
+    void finish(Reload& reload) {
+        std::uint32_t position = find(reload.key, Traits::hash(reload.key));
+        auto&& result = *reload.result;
+
+        if(position == none || !result.decoded) {
+            return;
+        }
+
+        Slot& slot = slots[position];
+
+        if(owners(slot) > 1) {
+            auto resource = Loader::create(result.decoded);
+
+            if(!resource) {
+                return;
+            }
+
+            --contents.find(slot.content)->second.aliases;
+            slot.resource = std::move(resource);
+            slot.content = 0;
+            resident[position].resource = slot.resource.get();
+        }
+        else {
+            if(!Loader::assign(*slot.resource, result.decoded)) {
+                return;
+            }
+
+            if(slot.content != 0) {
+                contents.erase(slot.content);
+                publish(slot.content, false);
+                slot.content = 0;
+            }
+
+            residentBytes -= slot.bytes;
+        }
+
+        ++stats.reloads;
+        slot.bytes = ResourceSize<Resource>::get(*slot.resource);
+        residentBytes += slot.bytes;
+        adopt(position, result.content);
+    }
+
+    // Only reached through reloader, so hot reloading is only compiled in
+    // for caches that call watch(). Others don't need a Loader that can
+    // decode from a filename or assign.
+    size_t uploadReloads(const sf::Clock& clock, sf::Time budget, size_t count) {
+        pollChanges();
+
+        for(auto it = reloads.begin(); it != reloads.end();) {
+            if(count > 0 && clock.getElapsedTime() >= budget) {
+                return count;
+            }
+
+            if(!(*it)->decoded.done()) {
+                ++it;
+                continue;
+            }
+
+            finish(**it);
+            it = reloads.erase(it);
+            ++count;
+        }
+
+        return count;
+    }
+
+    void waitForJobs() {
+        for(auto&& job : pending) {
+            job.second->jobs->wait(job.second->decoded);
+        }
+
+        for(auto&& reload : reloads) {
+            reload->jobs->wait(reload->decoded);
+        }
+    }
+
+    template<typename Callable>
+    void applyOne(Callable& func, const Lookup& key) {
+        auto ptr = get(key);
+        if(ptr) {
+            func(ptr);
+        }
+    }
 public:
     ResourceCache() = default;
-    ResourceCache(ResourceCache&&) = default;            // Implicitly delete copy
-    ResourceCache& operator=(ResourceCache&&) = default; // Implicitly delete copy
+    ResourceCache(ResourceCache&&) = default; // Implicitly delete copy
+
+    // Jobs still decoding into this cache's pending loads and reloads have
+    // to finish before those are replaced.
+    ResourceCache& operator=(ResourceCache&& other) {
+        if(this == &other) {
+            return *this;
+        }
 
+        waitForJobs();
+        index = std::move(other.index);
+        pending = std::move(other.pending);
+        slots = std::move(other.slots);
+        resident = std::move(other.resident);
+        freeSlots = std::move(other.freeSlots);
+        newest = other.newest;
+        oldest = other.oldest;
+        budget = other.budget;
+        residentBytes = other.residentBytes;
+        watcher = std::move(other.watcher);
+        watched = std::move(other.watched);
+        reloads = std::move(other.reloads);
+        reloader = other.reloader;
+        stats = other.stats;
+        contents = std::move(other.contents);
+        contentIndex = std::move(other.contentIndex);
+        return *this;
+    }
+
+    ~ResourceCache() {
+        waitForJobs();
+    }
+
+    // Decodes the resource on the JobSystem. The result only becomes visible
+    // through get() once upload() or wait() has finished it on the main thread.
     template<typename... Args>
-    auto insert(Key&& key, Args&&... args) -> decltype(*this) {
-        if(!cache.count(std::forward<Key>(key))) {
-            cache.emplace(std::forward<Key>(key), std::make_shared<Resource>(std::forward<Args>(args)...));
+    Future insertAsync(JobSystem& jobs, const Lookup& key, Args&&... args) {
+        size_t hash = Traits::hash(key);
+        std::uint32_t position = find(key, hash);
+
+        if(position != none) {
+            std::promise<std::shared_ptr<Resource>> ready;
+            ready.set_value(slots[position].resource);
+            return ready.get_future().share();
+        }
+
+        auto current = findPending(key, hash);
+
+        if(current != pending.end()) {
+            return current->second->future;
+        }
+
+        std::unique_ptr<Pending> job(new Pending{ Traits::make(key), &jobs, {}, std::make_shared<Decoding>(), {}, {}, {}, {} });
+        job->future = job->promise.get_future().share();
+
+        auto result = job->result;
+        auto known = contentIndex;
+        auto load = std::bind(LoadContent(), std::ref(*result), known.get(), true, args...);
+        job->decode = std::bind(Decode(), std::forward<Args>(args)...);
+
+        // known keeps the index alive for the job if the cache moves.
+        jobs.schedule([result, known, load]() mutable {
+            load();
+        }, &job->decoded);
+
+        Future future = job->future;
+        pending.emplace(hash, std::move(job));
+        return future;
+    }
+
+    // Finishes decoded resources and hot reloads on the calling thread until
+    // the budget is spent. At least one is finished per call if one is ready.
+    size_t upload(sf::Time budget) {
+        sf::Clock clock;
+        size_t count = 0;
+
+        for(auto it = pending.begin(); it != pending.end();) {
+            if(count > 0 && clock.getElapsedTime() >= budget) {
+                break;
+            }
+
+            if(!it->second->decoded.done()) {
+                ++it;
+                continue;
+            }
+
+            finish(it->first, *it->second);
+            it = pending.erase(it);
+            ++count;
+        }
+
+        if(reloader != nullptr) {
+            count = (this->*reloader)(clock, budget, count);
+        }
+
+        return count;
+    }
+
+    // Reloads the entry from filename on the JobSystem whenever the file
+    // changes on disk. The new contents are swapped in by upload().
+    // Watching the same key and filename again only changes the JobSystem
+    // later reloads run on.
+    bool watch(JobSystem& jobs, const Lookup& key, const std::string& filename) {
+        if(!watcher) {
+            watcher.reset(new FileWatcher());
+        }
+
+        reloader = &ResourceCache::uploadReloads;
+        auto&& keys = watched[filename];
+
+        for(auto&& existing : keys) {
+            if(Traits::equal(existing.first, key)) {
+                existing.second = &jobs;
+                return true;
+            }
+        }
+
+        if(keys.empty() && !watcher->add(filename)) {
+            watched.erase(filename);
+            return false;
+        }
+
+        keys.emplace_back(Traits::make(key), &jobs);
+        return true;
+    }
+
+    void unwatch(const Lookup& key) {
+        for(auto it = watched.begin(); it != watched.end();) {
+            auto&& keys = it->second;
+
+            for(auto k = keys.begin(); k != keys.end();) {
+                k = Traits::equal(k->first, key) ? keys.erase(k) : std::next(k);
+            }
+
+            if(keys.empty()) {
+                watcher->remove(it->first);
+                it = watched.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+
+    bool ready(const Lookup& key) const {
+        return find(key, Traits::hash(key)) != none;
+    }
+
+    bool isLoading() const noexcept {
+        return !pending.empty();
+    }
+
+    size_t getPendingCount() const noexcept {
+        return pending.size();
+    }
+
+    // Blocks until an asynchronously inserted resource is available,
+    // helping the JobSystem in the meantime.
+    std::shared_ptr<Resource> wait(const Lookup& key) {
+        size_t hash = Traits::hash(key);
+        auto it = findPending(key, hash);
+
+        if(it == pending.end()) {
+            return get(key);
+        }
+
+        it->second->jobs->wait(it->second->decoded);
+        auto resource = finish(hash, *it->second);
+        pending.erase(it);
+        return resource;
+    }
+
+    // Once the resident size exceeds the budget, the least recently used
+    // unpinned entries that nobody outside the cache references are evicted.
+    void setBudget(size_t bytes) {
+        budget = bytes;
+        trim();
+    }
+
+    size_t getBudget() const noexcept {
+        return budget;
+    }
+
+    size_t getResidentBytes() const noexcept {
+        return residentBytes;
+    }
+
+    // Hashes the file or archive entry each resource is loaded from through
+    // load() or insertAsync(). Keys whose contents are identical share a
+    // single resource, which is only decoded and counted once.
+    void setDeduplication(bool enabled) {
+        if(!enabled) {
+            contentIndex.reset();
+            return;
+        }
+
+        if(!contentIndex) {
+            contentIndex = std::make_shared<ContentIndex>();
+
+            for(auto&& entry : contents) {
+                contentIndex->hashes.insert(entry.first);
+            }
+        }
+    }
+
+    bool isDeduplicating() const noexcept {
+        return contentIndex != nullptr;
+    }
+
+    size_t getSize() const noexcept {
+        return index.size();
+    }
+
+    ResourceStats getStats() const {
+        ResourceStats result = stats;
+        result.residentCount = index.size();
+        result.residentBytes = residentBytes;
+        return result;
+    }
+
+    void resetStats() {
+        stats = ResourceStats();
+    }
+
+    // Evicts until the cache fits its budget or nothing else can be evicted.
+    // Resources only become evictable once their last outside reference
+    // is gone, so calling this periodically keeps the cache within budget.
+    void trim() {
+        evict(none);
+    }
+
+    template<typename... Args>
+    auto insert(const Lookup& key, Args&&... args) -> decltype(*this) {
+        size_t hash = Traits::hash(key);
+        if(find(key, hash) == none) {
+            store(hash, Traits::make(key), std::make_shared<Resource>(std::forward<Args>(args)...));
         }
         return *this;
     }
 
-    auto insert(Key&& key, Resource* resource) -> decltype(*this) {
-        if(!cache.count(std::forward<Key>(key))) {
-            cache.emplace(std::forward<Key>(key), std::shared_ptr<Resource>(resource));
+    auto insert(const Lookup& key, Resource* resource) -> decltype(*this) {
+        size_t hash = Traits::hash(key);
+        if(resource != nullptr && find(key, hash) == none) {
+            store(hash, Traits::make(key), std::shared_ptr<Resource>(resource));
         }
         return *this;
     }
 
-    auto release(Key&& key) -> decltype(*this) {
-        auto it = cache.find(std::forward<Key>(key));
-        if(it != cache.end()) {
-            it->second.reset();
+    // Decodes and creates the resource through the Loader on the calling
+    // thread, e.g. load(key, archive.find(key)). Returns null on failure.
+    template<typename... Args>
+    std::shared_ptr<Resource> load(const Lookup& key, Args&&... args) {
+        size_t hash = Traits::hash(key);
+        std::uint32_t position = find(key, hash);
+
+        if(position != none) {
+            touch(position);
+            return slots[position].resource;
+        }
+
+        sf::Clock clock;
+        Decoding result;
+        LoadContent()(result, contentIndex.get(), true, args...);
+        auto resource = shared(result.content);
+
+        if(resource) {
+            ++stats.deduplicated;
+        }
+        else if(result.decoded || result.skipped) {
+            if(result.skipped) {
+                result.decoded = Loader::decode(std::forward<Args>(args)...);
+            }
+
+            resource = Loader::create(result.decoded);
+        }
+
+        if(resource) {
+            store(hash, Traits::make(key), resource, result.content);
+        }
+        else {
+            ++stats.failures;
+        }
+
+        stats.recordLoad(clock.getElapsedTime());
+
+        return resource;
+    }
+
+    // Pinned entries are neither released nor evicted.
+    auto release(const Lookup& key) -> decltype(*this) {
+        std::uint32_t position = find(key, Traits::hash(key));
+        if(position != none && slots[position].pins == 0) {
+            erase(position);
+            ++stats.releases;
         }
         return *this;
     }
 
     template<class Callable>
     auto apply(Callable&& func) -> decltype(*this) {
-        for(auto&& ptrpair : cache) {
-            if(ptrpair.second) {
-                func(ptrpair.second);
+        for(auto&& slot : slots) {
+            if(slot.resource) {
+                func(slot.resource);
             }
         }
 
@@ -71,25 +896,64 @@ public:
     }
 
     template<class Callable, typename... Keys>
-    auto apply(Callable&& func, Keys&&... keys) -> decltype(*this) {
-        Key indices[sizeof...(keys)] = { std::forward<Keys>(keys)... };
-        for(auto&& index : indices) {
-            auto ptr = this->get(index);
-            if(ptr) {
-                func(ptr);
-            }
+    auto apply(Callable&& func, const Keys&... keys) -> decltype(*this) {
+        using swallow = int[];
+        (void)swallow{ 0, (applyOne(func, keys), 0)... };
+        return *this;
+    }
+
+    std::shared_ptr<Resource> get(const Lookup& key) {
+        std::uint32_t position = find(key, Traits::hash(key));
+        if(position != none) {
+            ++stats.hits;
+            touch(position);
+            return slots[position].resource;
         }
+        ++stats.misses;
+        return nullptr;
+    }
 
-        return *this;
+    // Looks the key up once so later accesses can go through resolve().
+    Handle handle(const Lookup& key) {
+        std::uint32_t position = find(key, Traits::hash(key));
+        if(position != none) {
+            ++stats.hits;
+            touch(position);
+            return Handle(position, resident[position].generation);
+        }
+        ++stats.misses;
+        return Handle();
     }
 
-    std::shared_ptr<Resource> get(Key&& key) {
-        auto it = cache.find(std::forward<Key>(key));
-        if(it != cache.end()) {
-            return it->second;
+    // A bounds check, a generation compare and a load. Returns null for
+    // handles whose entry is gone. Does not count as a use for eviction,
+    // and the pointer is only guaranteed to stay valid while pinned.
+    Resource* resolve(Handle handle) const noexcept {
+        auto position = handle.index();
+        if(position < resident.size() && resident[position].generation == handle.generation()) {
+            return resident[position].resource;
         }
         return nullptr;
     }
+
+    // Keeps the entry alive until a matching unpin, regardless of budget.
+    bool pin(Handle handle) {
+        if(!valid(handle)) {
+            return false;
+        }
+
+        ++slots[handle.index()].pins;
+        return true;
+    }
+
+    bool unpin(Handle handle) {
+        if(!valid(handle) || slots[handle.index()].pins == 0) {
+            return false;
+        }
+
+        --slots[handle.index()].pins;
+        return true;
+    }
 };
 } // sky
 
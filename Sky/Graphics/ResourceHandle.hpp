@@ -0,0 +1,72 @@
+// The zlib/libpng License
+
+// Copyright (c) 2014 Danny Y., Rapptz
+
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+
+// Permission is granted to anyone to use this software for any purpose, including
+// commercial applications, and to alter it and redistribute it freely, subject to
+// the following restrictions:
+
+// 1. The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software. If you use this software in a product,
+// an acknowledgment in the product documentation would be appreciated but is
+// not required.
+
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef SKY_RESOURCEHANDLE_HPP
+#define SKY_RESOURCEHANDLE_HPP
+
+#include <cstdint>
+
+namespace sky {
+// 32-bit reference to a ResourceCache slot: the low bits are the slot
+// index and the high bits the generation the slot had when the handle was
+// made. Once the slot is released or evicted its generation changes and
+// the handle resolves to null. A default constructed handle is null.
+template<class Resource>
+class ResourceHandle {
+private:
+    std::uint32_t value = 0;
+public:
+    static constexpr unsigned indexBits = 20;
+    static constexpr std::uint32_t indexMask = (1u << indexBits) - 1;
+    static constexpr std::uint32_t generationMask = (1u << (32 - indexBits)) - 1;
+
+    constexpr ResourceHandle() noexcept = default;
+    constexpr ResourceHandle(std::uint32_t index, std::uint32_t generation) noexcept:
+    value((generation << indexBits) | (index & indexMask)) {}
+
+    constexpr std::uint32_t index() const noexcept {
+        return value & indexMask;
+    }
+
+    constexpr std::uint32_t generation() const noexcept {
+        return value >> indexBits;
+    }
+
+    constexpr std::uint32_t getValue() const noexcept {
+        return value;
+    }
+
+    explicit constexpr operator bool() const noexcept {
+        return value != 0;
+    }
+
+    friend constexpr bool operator==(const ResourceHandle& lhs, const ResourceHandle& rhs) noexcept {
+        return lhs.value == rhs.value;
+    }
+
+    friend constexpr bool operator!=(const ResourceHandle& lhs, const ResourceHandle& rhs) noexcept {
+        return lhs.value != rhs.value;
+    }
+};
+} // sky
+
+#endif // SKY_RESOURCEHANDLE_HPP
@@ -0,0 +1,73 @@
+// The zlib/libpng License
+
+// Copyright (c) 2014 Danny Y., Rapptz
+
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+
+// Permission is granted to anyone to use this software for any purpose, including
+// commercial applications, and to alter it and redistribute it freely, subject to
+// the following restrictions:
+
+// 1. The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software. If you use this software in a product,
+// an acknowledgment in the product documentation would be appreciated but is
+// not required.
+
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef SKY_RESOURCEKEY_HPP
+#define SKY_RESOURCEKEY_HPP
+
+#include "../Utility/HashedString.hpp"
+#include <cstddef>
+#include <functional>
+#include <string>
+
+namespace sky {
+// Describes how ResourceCache hashes and compares its keys. Lookup is the
+// type lookups are made with, which may differ from the stored Key so
+// that finding an entry doesn't require constructing a Key.
+template<class Key>
+struct ResourceKey {
+    using Lookup = Key;
+
+    static std::size_t hash(const Lookup& key) {
+        return std::hash<Key>()(key);
+    }
+
+    static bool equal(const Key& key, const Lookup& lookup) {
+        return key == lookup;
+    }
+
+    static Key make(const Lookup& lookup) {
+        return lookup;
+    }
+};
+
+// String keys are looked up through HashedString, so string literals,
+// const char* and std::string all work without allocating, and a
+// HashedString kept around skips hashing altogether.
+template<>
+struct ResourceKey<std::string> {
+    using Lookup = HashedString;
+
+    static std::size_t hash(const Lookup& key) {
+        return static_cast<std::size_t>(key.hash());
+    }
+
+    static bool equal(const std::string& key, const Lookup& lookup) {
+        return key.size() == lookup.size() && key.compare(0, key.size(), lookup.data(), lookup.size()) == 0;
+    }
+
+    static std::string make(const Lookup& lookup) {
+        return lookup.toString();
+    }
+};
+} // sky
+
+#endif // SKY_RESOURCEKEY_HPP
@@ -0,0 +1,122 @@
+// The zlib/libpng License
+
+// Copyright (c) 2014 Danny Y., Rapptz
+
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+
+// Permission is granted to anyone to use this software for any purpose, including
+// commercial applications, and to alter it and redistribute it freely, subject to
+// the following restrictions:
+
+// 1. The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software. If you use this software in a product,
+// an acknowledgment in the product documentation would be appreciated but is
+// not required.
+
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef SKY_RESOURCELOADER_HPP
+#define SKY_RESOURCELOADER_HPP
+
+#include "../Utility/Archive.hpp"
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace sky {
+// Splits the construction of a resource in two. decode() may run on any
+// thread and does the expensive work, create() runs on the main thread and
+// turns the decoded data into the final resource. Either returning null
+// means the resource failed to load. assign() replaces the contents of an
+// existing resource in place, which is how hot reloading keeps every
+// outstanding reference valid. The specialisations for SFML's graphics
+// resources are in GraphicsResources.hpp.
+template<class Resource>
+struct ResourceLoader {
+    using Decoded = std::unique_ptr<Resource>;
+
+    template<typename... Args>
+    static auto decode(Args&&... args) -> decltype(Decoded(new Resource(std::forward<Args>(args)...))) {
+        return Decoded(new Resource(std::forward<Args>(args)...));
+    }
+
+    static std::shared_ptr<Resource> create(Decoded& decoded) {
+        return std::shared_ptr<Resource>(std::move(decoded));
+    }
+
+    static bool assign(Resource& target, Decoded& decoded) {
+        if(!decoded) {
+            return false;
+        }
+
+        target = std::move(*decoded);
+        return true;
+    }
+};
+
+// Loader for types with loadFromFile and loadFromMemory members that need
+// no main thread work.
+// Specialise ResourceLoader with it for your own types, e.g.
+// template<> struct ResourceLoader<sf::SoundBuffer> : FileLoader<sf::SoundBuffer> {};
+template<class Resource>
+struct FileLoader {
+    using Decoded = std::unique_ptr<Resource>;
+
+    static Decoded decode(const std::string& filename) {
+        Decoded resource(new Resource());
+
+        if(!resource->loadFromFile(filename)) {
+            resource.reset();
+        }
+
+        return resource;
+    }
+
+    static Decoded decode(const ArchiveEntry& entry) {
+        std::vector<char> buffer;
+        const char* data = entry ? entry.view(buffer) : nullptr;
+        Decoded resource;
+
+        if(data != nullptr) {
+            resource.reset(new Resource());
+
+            if(!resource->loadFromMemory(data, entry.getSize())) {
+                resource.reset();
+            }
+        }
+
+        return resource;
+    }
+
+    static std::shared_ptr<Resource> create(Decoded& decoded) {
+        return std::shared_ptr<Resource>(std::move(decoded));
+    }
+
+    static bool assign(Resource& target, Decoded& decoded) {
+        if(!decoded) {
+            return false;
+        }
+
+        target = std::move(*decoded);
+        return true;
+    }
+};
+
+// Whether Loader can decode from an ArchiveEntry whose memory is released
+// as soon as decode() returns. ResourceCache uses this to read a file only
+// once when it also needs to hash the contents.
+template<class Loader, typename = void>
+struct DecodesFromMemory : std::false_type {};
+
+template<class Loader>
+struct DecodesFromMemory<Loader, decltype(void(Loader::decode(std::declval<const ArchiveEntry&>())))> : std::true_type {};
+} // sky
+
+#endif // SKY_RESOURCELOADER_HPP
@@ -0,0 +1,121 @@
+// The zlib/libpng License
+
+// Copyright (c) 2014 Danny Y., Rapptz
+
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+
+// Permission is granted to anyone to use this software for any purpose, including
+// commercial applications, and to alter it and redistribute it freely, subject to
+// the following restrictions:
+
+// 1. The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software. If you use this software in a product,
+// an acknowledgment in the product documentation would be appreciated but is
+// not required.
+
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef SKY_RESOURCESTATS_HPP
+#define SKY_RESOURCESTATS_HPP
+
+#include <SFML/System/Time.hpp>
+#include <array>
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+namespace sky {
+// Counters kept by a ResourceCache. Load times cover everything from
+// the request until the resource is usable, including time spent queued.
+struct ResourceStats {
+    // Bucket 0 counts loads under 1ms, bucket i loads under 2^i ms
+    // and the last one everything slower than that.
+    static constexpr size_t bucketCount = 12;
+
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+    std::uint64_t inserts = 0;
+    std::uint64_t evictions = 0;
+    std::uint64_t releases = 0;
+    std::uint64_t reloads = 0;
+    std::uint64_t deduplicated = 0;
+    std::uint64_t loads = 0;
+    std::uint64_t failures = 0;
+    size_t residentCount = 0;
+    size_t residentBytes = 0;
+    sf::Time totalLoadTime;
+    sf::Time maxLoadTime;
+    std::array<std::uint64_t, bucketCount> loadTimes{};
+
+    // Exclusive upper bound of a bucket. Zero for the last one.
+    static sf::Time getBucketLimit(size_t bucket) {
+        return bucket + 1 < bucketCount ? sf::milliseconds(1 << bucket) : sf::Time::Zero;
+    }
+
+    void recordLoad(sf::Time elapsed) {
+        size_t bucket = 0;
+
+        while(bucket + 1 < bucketCount && elapsed >= getBucketLimit(bucket)) {
+            ++bucket;
+        }
+
+        ++loadTimes[bucket];
+        ++loads;
+        totalLoadTime += elapsed;
+
+        if(elapsed > maxLoadTime) {
+            maxLoadTime = elapsed;
+        }
+    }
+
+    float getHitRate() const noexcept {
+        return hits + misses == 0 ? 0.f : static_cast<float>(hits) / (hits + misses);
+    }
+
+    sf::Time getAverageLoadTime() const {
+        return loads == 0 ? sf::Time::Zero : sf::microseconds(totalLoadTime.asMicroseconds() / static_cast<sf::Int64>(loads));
+    }
+
+    // Times are in microseconds.
+    std::string toJSON() const {
+        std::ostringstream out;
+        out << "{\"hits\":" << hits
+            << ",\"misses\":" << misses
+            << ",\"inserts\":" << inserts
+            << ",\"evictions\":" << evictions
+            << ",\"releases\":" << releases
+            << ",\"reloads\":" << reloads
+            << ",\"deduplicated\":" << deduplicated
+            << ",\"loads\":" << loads
+            << ",\"failures\":" << failures
+            << ",\"residentCount\":" << residentCount
+            << ",\"residentBytes\":" << residentBytes
+            << ",\"totalLoadTime\":" << totalLoadTime.asMicroseconds()
+            << ",\"maxLoadTime\":" << maxLoadTime.asMicroseconds()
+            << ",\"loadTimes\":[";
+
+        for(size_t i = 0; i < bucketCount; ++i) {
+            out << (i == 0 ? "" : ",") << "{\"below\":";
+
+            if(i + 1 < bucketCount) {
+                out << getBucketLimit(i).asMicroseconds();
+            }
+            else {
+                out << "null";
+            }
+
+            out << ",\"count\":" << loadTimes[i] << '}';
+        }
+
+        out << "]}";
+        return out.str();
+    }
+};
+} // sky
+
+#endif // SKY_RESOURCESTATS_HPP
@@ -0,0 +1,320 @@
+// The zlib/libpng License
+
+// Copyright (c) 2014 Danny Y., Rapptz
+
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+
+// Permission is granted to anyone to use this software for any purpose, including
+// commercial applications, and to alter it and redistribute it freely, subject to
+// the following restrictions:
+
+// 1. The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software. If you use this software in a product,
+// an acknowledgment in the product documentation would be appreciated but is
+// not required.
+
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef SKY_SHADERANIMATION_HPP
+#define SKY_SHADERANIMATION_HPP
+
+#include "AnimatedSprite.hpp"
+#include "RenderStats.hpp"
+#include "SpriteBatch.hpp"
+#include <SFML/Graphics/Drawable.hpp>
+#include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/Shader.hpp>
+#include <SFML/Graphics/Transform.hpp>
+#include <SFML/Graphics/Vertex.hpp>
+#include <SFML/System/Time.hpp>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace sky {
+// Draws many copies of one animation strip, with the frame chosen in a
+// vertex shader. Each quad stores the time it started playing in its
+// vertex colour (24 bits of milliseconds, which wrap after about 4.6
+// hours) and the shader offsets the texture coordinates of the first
+// frame by the current frame. Once a quad is added the CPU never touches
+// its vertices again. Because of that, an instance that doesn't loop and
+// was added more than 4.6 hours ago starts playing again; clear() and add
+// such long lived instances again if that matters.
+//
+// Only strips work this way: every frame has the same size and they sit
+// in a row at a constant horizontal step. Instances are drawn opaque
+// white. When shaders are unavailable the same instances are animated
+// with AnimatedSprite on the CPU instead, picking frames the same way.
+class ShaderAnimationBatch : public sf::Drawable {
+private:
+    struct Instance {
+        AnimatedSprite sprite;
+        sf::Transform transform;
+        std::int64_t start;
+        size_t frame;
+    };
+
+    static const char* vertexSource() {
+        return "#version 110\n"
+               "uniform float time;\n"
+               "uniform float delay;\n"
+               "uniform float frameCount;\n"
+               "uniform float frameStep;\n"
+               "uniform float looped;\n"
+               "void main() {\n"
+               "    vec3 bytes = floor(gl_Color.rgb * 255.0 + 0.5);\n"
+               "    float start = bytes.r * 65536.0 + bytes.g * 256.0 + bytes.b;\n"
+               "    float age = time - start;\n"
+               "    if(age < 0.0) {\n"
+               "        age += 16777216.0;\n"
+               "    }\n"
+               "    float frame = floor(age / delay);\n"
+               "    if(frame >= frameCount) {\n"
+               "        frame = looped > 0.5 ? mod(frame, frameCount) : 0.0;\n"
+               "    }\n"
+               "    vec4 texCoord = gl_MultiTexCoord0 + vec4(frame * frameStep, 0.0, 0.0, 0.0);\n"
+               "    gl_TexCoord[0] = gl_TextureMatrix[0] * texCoord;\n"
+               "    gl_Position = gl_ModelViewProjectionMatrix * gl_Vertex;\n"
+               "    gl_FrontColor = vec4(1.0, 1.0, 1.0, gl_Color.a);\n"
+               "}\n";
+    }
+
+    static const char* fragmentSource() {
+        return "#version 110\n"
+               "uniform sampler2D texture;\n"
+               "void main() {\n"
+               "    gl_FragColor = gl_Color * texture2D(texture, gl_TexCoord[0].xy);\n"
+               "}\n";
+    }
+
+    static const std::int64_t period = 1 << 24;
+
+    const Animation* animation = nullptr;
+    sf::Shader shader;
+    std::vector<sf::Vertex> vertices;
+    std::vector<Instance> instances;
+    SpriteBatch fallback;
+    sf::Time delay = sf::seconds(0.1f);
+    sf::Time elapsed;
+    bool looped = true;
+    bool shaderLoaded = false;
+    bool shaderTried = false;
+
+    // Milliseconds since the batch started, wrapped to 24 bits.
+    std::int64_t now() const noexcept {
+        return (elapsed.asMicroseconds() / 1000) % period;
+    }
+
+    // Mirrors the vertex shader. A strip that doesn't loop goes back to its
+    // first frame once it's done, the same as AnimatedSprite.
+    size_t frameAt(std::int64_t start) const {
+        std::int64_t age = (now() - start + period) % period;
+        size_t frame = static_cast<size_t>(std::floor(static_cast<float>(age) / delayMilliseconds()));
+        size_t count = animation->getSize();
+
+        if(frame >= count) {
+            frame = looped ? frame % count : 0;
+        }
+
+        return frame;
+    }
+
+    // Fractional, so e.g. a 1/60 s delay doesn't turn into 16 ms.
+    float delayMilliseconds() const noexcept {
+        float milliseconds = static_cast<float>(delay.asMicroseconds()) / 1000.f;
+        return milliseconds > 0.f ? milliseconds : 1.f;
+    }
+
+    std::int64_t startTime(sf::Time offset) const noexcept {
+        std::int64_t start = (now() - offset.asMicroseconds() / 1000) % period;
+        return start < 0 ? start + period : start;
+    }
+
+    void updateUniforms() {
+        if(!shaderLoaded || animation == nullptr) {
+            return;
+        }
+
+        float step = animation->getSize() > 1 ? static_cast<float>(animation->getFrame(1).left - animation->getFrame(0).left) : 0.f;
+        shader.setUniform("time", static_cast<float>(now()));
+        shader.setUniform("delay", delayMilliseconds());
+        shader.setUniform("frameCount", static_cast<float>(animation->getSize()));
+        shader.setUniform("frameStep", step);
+        shader.setUniform("looped", looped ? 1.f : 0.f);
+        shader.setUniform("texture", sf::Shader::CurrentTexture);
+    }
+
+    void rebuildFallback() {
+        fallback.clear();
+
+        for(auto&& instance : instances) {
+            fallback.add(instance.sprite.getVertices(), animation->getTexture(), instance.transform);
+        }
+    }
+
+    virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const {
+        if(animation == nullptr) {
+            return;
+        }
+
+        if(!shaderLoaded) {
+            target.draw(fallback, states);
+            return;
+        }
+
+        if(!vertices.empty()) {
+            states.texture = animation->getTexture();
+            states.shader = &shader;
+            RenderStats::Scope scope(RenderStats::Batches, vertices.size(), states.texture);
+            target.draw(vertices.data(), vertices.size(), sf::Quads, states);
+        }
+    }
+public:
+    ShaderAnimationBatch() = default;
+
+    // True when every frame of the animation can be reached from the first
+    // one by a constant horizontal offset.
+    static bool isStrip(const Animation& animation) {
+        if(animation.getSize() == 0) {
+            return false;
+        }
+
+        const sf::IntRect& first = animation.getFrame(0);
+        int step = animation.getSize() > 1 ? animation.getFrame(1).left - first.left : 0;
+
+        for(size_t i = 1; i < animation.getSize(); ++i) {
+            const sf::IntRect& frame = animation.getFrame(i);
+
+            if(frame.left != first.left + step * static_cast<int>(i) || frame.top != first.top ||
+               frame.width != first.width || frame.height != first.height) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // Removes every instance. Returns false if the animation isn't a strip.
+    // The animation has to outlive the batch.
+    bool setAnimation(const Animation& animation, sf::Time delay = sf::seconds(0.1f), bool looped = true) {
+        if(!isStrip(animation)) {
+            return false;
+        }
+
+        if(!shaderTried) {
+            shaderTried = true;
+            shaderLoaded = sf::Shader::isAvailable() && shader.loadFromMemory(vertexSource(), fragmentSource());
+        }
+
+        this->animation = &animation;
+        this->delay = delay;
+        this->looped = looped;
+        clear();
+        updateUniforms();
+        return true;
+    }
+
+    const Animation* getAnimation() const noexcept {
+        return animation;
+    }
+
+    // Whether frames are picked on the GPU rather than by the fallback.
+    bool isUsingShader() const noexcept {
+        return shaderLoaded;
+    }
+
+    void setDelay(sf::Time delay) {
+        this->delay = delay;
+        updateUniforms();
+    }
+
+    sf::Time getDelay() const noexcept {
+        return delay;
+    }
+
+    void setLooped(bool looped) {
+        this->looped = looped;
+        updateUniforms();
+    }
+
+    bool isLooped() const noexcept {
+        return looped;
+    }
+
+    // Spawns an instance that behaves as if it had already been
+    // playing for offset. Does nothing without an animation.
+    void add(const sf::Transform& transform, sf::Time offset = sf::Time::Zero) {
+        if(animation == nullptr) {
+            return;
+        }
+
+        std::int64_t start = startTime(offset);
+
+        if(!shaderLoaded) {
+            Instance instance{ AnimatedSprite(*animation, delay), transform, start, frameAt(start) };
+            instance.sprite.setFrame(instance.frame);
+            fallback.add(instance.sprite.getVertices(), animation->getTexture(), transform);
+            instances.push_back(std::move(instance));
+            return;
+        }
+
+        sf::Vertex quad;
+        quad.color = sf::Color(static_cast<sf::Uint8>(start >> 16), static_cast<sf::Uint8>(start >> 8), static_cast<sf::Uint8>(start));
+        const FrameQuad& frame = animation->getQuad(0);
+
+        for(unsigned i = 0; i < 4; ++i) {
+            quad.position = transform.transformPoint(frame.positions[i]);
+            quad.texCoords = frame.texCoords[i];
+            vertices.push_back(quad);
+        }
+    }
+
+    void clear() {
+        vertices.clear();
+        instances.clear();
+        fallback.clear();
+    }
+
+    size_t getSize() const noexcept {
+        return shaderLoaded ? vertices.size() / 4 : instances.size();
+    }
+
+    // Advances the clock shared by every instance. Only the fallback
+    // path has per instance work to do here.
+    void update(sf::Time deltaTime) {
+        elapsed += deltaTime;
+
+        if(shaderLoaded) {
+            updateUniforms();
+            return;
+        }
+
+        if(animation == nullptr) {
+            return;
+        }
+
+        bool changed = false;
+
+        for(auto&& instance : instances) {
+            size_t frame = frameAt(instance.start);
+
+            if(frame != instance.frame) {
+                instance.frame = frame;
+                instance.sprite.setFrame(frame);
+                changed = true;
+            }
+        }
+
+        if(changed) {
+            rebuildFallback();
+        }
+    }
+};
+} // sky
+
+#endif // SKY_SHADERANIMATION_HPP
@@ -0,0 +1,262 @@
+// The zlib/libpng License
+
+// Copyright (c) 2014 Danny Y., Rapptz
+
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+
+// Permission is granted to anyone to use this software for any purpose, including
+// commercial applications, and to alter it and redistribute it freely, subject to
+// the following restrictions:
+
+// 1. The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software. If you use this software in a product,
+// an acknowledgment in the product documentation would be appreciated but is
+// not required.
+
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef SKY_SPATIALHASH_HPP
+#define SKY_SPATIALHASH_HPP
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/Graphics/View.hpp>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace sky {
+// Uniform grid over world space for culling. Items are stored with their
+// bounds, usually getGlobalBounds(), in every cell they overlap, so a
+// query only looks at the cells it covers. Moving an item within the same
+// cells only stores the new bounds.
+//
+//   SpatialHash<AnimatedSprite*> visible(128.f);
+//   auto id = visible.insert(&sprite, sprite.getGlobalBounds());
+//   visible.update(id, sprite.getGlobalBounds());
+//   visible.query(window.getView(), [&](AnimatedSprite* s) { batch.add(*s); });
+template<typename T>
+class SpatialHash {
+public:
+    using Id = std::uint32_t;
+private:
+    struct Cells {
+        int left;
+        int top;
+        int right;
+        int bottom;
+
+        bool operator==(const Cells& other) const noexcept {
+            return left == other.left && top == other.top && right == other.right && bottom == other.bottom;
+        }
+    };
+
+    struct Entry {
+        T value;
+        sf::FloatRect bounds;
+        Cells cells;
+        std::uint32_t stamp;
+        bool alive;
+    };
+
+    std::vector<Entry> entries;
+    std::vector<Id> freeIds;
+    std::unordered_map<std::uint64_t, std::vector<Id>> grid;
+    float cellSize;
+    std::uint32_t stamp = 0;
+    size_t count = 0;
+
+    static std::uint64_t key(int x, int y) noexcept {
+        return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32) | static_cast<std::uint32_t>(y);
+    }
+
+    Cells cover(const sf::FloatRect& bounds) const {
+        return Cells{ static_cast<int>(std::floor(bounds.left / cellSize)),
+                      static_cast<int>(std::floor(bounds.top / cellSize)),
+                      static_cast<int>(std::floor((bounds.left + bounds.width) / cellSize)),
+                      static_cast<int>(std::floor((bounds.top + bounds.height) / cellSize)) };
+    }
+
+    static bool overlaps(const sf::FloatRect& lhs, const sf::FloatRect& rhs) noexcept {
+        return lhs.left <= rhs.left + rhs.width && rhs.left <= lhs.left + lhs.width &&
+               lhs.top <= rhs.top + rhs.height && rhs.top <= lhs.top + lhs.height;
+    }
+
+    void link(Id id, const Cells& cells) {
+        for(int y = cells.top; y <= cells.bottom; ++y) {
+            for(int x = cells.left; x <= cells.right; ++x) {
+                grid[key(x, y)].push_back(id);
+            }
+        }
+    }
+
+    void unlink(Id id, const Cells& cells) {
+        for(int y = cells.top; y <= cells.bottom; ++y) {
+            for(int x = cells.left; x <= cells.right; ++x) {
+                auto it = grid.find(key(x, y));
+                auto&& ids = it->second;
+
+                for(size_t i = 0; i < ids.size(); ++i) {
+                    if(ids[i] == id) {
+                        ids[i] = ids.back();
+                        ids.pop_back();
+                        break;
+                    }
+                }
+
+                if(ids.empty()) {
+                    grid.erase(it);
+                }
+            }
+        }
+    }
+
+    Entry& entry(Id id) {
+        if(!contains(id)) {
+            throw std::out_of_range("SpatialHash has no such item");
+        }
+
+        return entries[id];
+    }
+public:
+    // Cells should be around the size of a typical item or a bit larger.
+    explicit SpatialHash(float cellSize = 128.f): cellSize(cellSize) {}
+
+    Id insert(const T& value, const sf::FloatRect& bounds) {
+        Id id;
+
+        if(!freeIds.empty()) {
+            id = freeIds.back();
+            freeIds.pop_back();
+        }
+        else {
+            id = static_cast<Id>(entries.size());
+            entries.push_back(Entry{ value, bounds, Cells(), 0, false });
+        }
+
+        Entry& item = entries[id];
+        item.value = value;
+        item.bounds = bounds;
+        item.cells = cover(bounds);
+        item.alive = true;
+        link(id, item.cells);
+        ++count;
+        return id;
+    }
+
+    void update(Id id, const sf::FloatRect& bounds) {
+        Entry& item = entry(id);
+        Cells cells = cover(bounds);
+        item.bounds = bounds;
+
+        if(!(cells == item.cells)) {
+            unlink(id, item.cells);
+            link(id, cells);
+            item.cells = cells;
+        }
+    }
+
+    void remove(Id id) {
+        Entry& item = entry(id);
+        unlink(id, item.cells);
+        item.alive = false;
+        item.value = T();
+        freeIds.push_back(id);
+        --count;
+    }
+
+    bool contains(Id id) const noexcept {
+        return id < entries.size() && entries[id].alive;
+    }
+
+    void clear() {
+        entries.clear();
+        freeIds.clear();
+        grid.clear();
+        count = 0;
+    }
+
+    size_t getSize() const noexcept {
+        return count;
+    }
+
+    const T& get(Id id) {
+        return entry(id).value;
+    }
+
+    const sf::FloatRect& getBounds(Id id) {
+        return entry(id).bounds;
+    }
+
+    // Calls func once with every item whose bounds overlap area.
+    template<typename Callable>
+    void query(const sf::FloatRect& area, Callable&& func) {
+        // Items spanning several cells are only reported the first time.
+        if(++stamp == 0) {
+            for(auto&& item : entries) {
+                item.stamp = 0;
+            }
+
+            stamp = 1;
+        }
+
+        Cells cells = cover(area);
+
+        for(int y = cells.top; y <= cells.bottom; ++y) {
+            for(int x = cells.left; x <= cells.right; ++x) {
+                auto it = grid.find(key(x, y));
+
+                if(it == grid.end()) {
+                    continue;
+                }
+
+                for(auto id : it->second) {
+                    Entry& item = entries[id];
+
+                    if(item.stamp != stamp && overlaps(item.bounds, area)) {
+                        item.stamp = stamp;
+                        func(item.value);
+                    }
+                }
+            }
+        }
+    }
+
+    // Everything visible through view, taking its rotation into account.
+    template<typename Callable>
+    void query(const sf::View& view, Callable&& func) {
+        query(getViewBounds(view), std::forward<Callable>(func));
+    }
+
+    std::vector<T> query(const sf::FloatRect& area) {
+        std::vector<T> result;
+        query(area, [&result](const T& value) { result.push_back(value); });
+        return result;
+    }
+
+    std::vector<T> query(const sf::View& view) {
+        return query(getViewBounds(view));
+    }
+
+    // Axis aligned box around what a possibly rotated view shows.
+    static sf::FloatRect getViewBounds(const sf::View& view) {
+        float radians = view.getRotation() * 3.14159265f / 180.f;
+        float cosine = std::abs(std::cos(radians));
+        float sine = std::abs(std::sin(radians));
+        auto size = view.getSize();
+        auto center = view.getCenter();
+        float width = size.x * cosine + size.y * sine;
+        float height = size.x * sine + size.y * cosine;
+        return sf::FloatRect(center.x - width / 2.f, center.y - height / 2.f, width, height);
+    }
+};
+} // sky
+
+#endif // SKY_SPATIALHASH_HPP
@@ -0,0 +1,167 @@
+// The zlib/libpng License
+
+// Copyright (c) 2014 Danny Y., Rapptz
+
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+
+// Permission is granted to anyone to use this software for any purpose, including
+// commercial applications, and to alter it and redistribute it freely, subject to
+// the following restrictions:
+
+// 1. The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software. If you use this software in a product,
+// an acknowledgment in the product documentation would be appreciated but is
+// not required.
+
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef SKY_SPRITEBATCH_HPP
+#define SKY_SPRITEBATCH_HPP
+
+#include "AnimatedSprite.hpp"
+#include "RenderQueue.hpp"
+#include "RenderStats.hpp"
+#include "../Concurrency/JobSystem.hpp"
+#include <SFML/Graphics/Drawable.hpp>
+#include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/Texture.hpp>
+#include <SFML/Graphics/Transform.hpp>
+#include <SFML/Graphics/Vertex.hpp>
+#include <vector>
+
+namespace sky {
+// Collects quads into one pre-transformed vertex buffer. Consecutive quads
+// sharing a texture are drawn with a single draw call, so sorting what is
+// added by texture keeps the number of calls down. Drawing order matches
+// the order quads were added in.
+class SpriteBatch : public sf::Drawable {
+private:
+    struct Batch {
+        const sf::Texture* texture;
+        size_t first;
+        size_t count;
+    };
+
+    std::vector<sf::Vertex> vertices;
+    std::vector<Batch> batches;
+
+    virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const {
+        for(auto&& batch : batches) {
+            states.texture = batch.texture;
+            RenderStats::Scope scope(RenderStats::Batches, batch.count, batch.texture);
+            target.draw(&vertices[batch.first], batch.count, sf::Quads, states);
+        }
+    }
+public:
+    SpriteBatch() = default;
+
+    void clear() {
+        vertices.clear();
+        batches.clear();
+    }
+
+    void reserve(size_t quads) {
+        vertices.reserve(quads * 4);
+    }
+
+    void add(const sf::Vertex* quad, const sf::Texture* texture, const sf::Transform& transform = sf::Transform::Identity) {
+        if(batches.empty() || batches.back().texture != texture) {
+            batches.push_back(Batch{ texture, vertices.size(), 0 });
+        }
+
+        for(unsigned i = 0; i < 4; ++i) {
+            vertices.push_back(quad[i]);
+            vertices.back().position = transform.transformPoint(quad[i].position);
+        }
+
+        batches.back().count += 4;
+    }
+
+    void add(const AnimatedSprite& sprite) {
+        if(sprite.getAnimation() != nullptr && sprite.getTexture() != nullptr) {
+            add(sprite.getVertices(), sprite.getTexture(), sprite.getTransform());
+        }
+    }
+
+    template<typename Iterator>
+    void add(Iterator first, Iterator last) {
+        for(; first != last; ++first) {
+            add(*first);
+        }
+    }
+
+    // Adds a range of AnimatedSprites with the vertices transformed on the
+    // job system's threads. The batches and the place each sprite goes in
+    // the buffer are worked out up front, so every thread writes into its
+    // own slice of the already sized buffer.
+    template<typename RandomAccessIterator>
+    void add(RandomAccessIterator first, RandomAccessIterator last, JobSystem& jobs, size_t grain = 0) {
+        static const size_t skipped = static_cast<size_t>(-1);
+        size_t count = static_cast<size_t>(last - first);
+        size_t end = vertices.size();
+        std::vector<size_t> offsets(count);
+
+        for(size_t i = 0; i < count; ++i) {
+            const AnimatedSprite& sprite = first[i];
+            const sf::Texture* texture = sprite.getTexture();
+
+            if(sprite.getAnimation() == nullptr || texture == nullptr) {
+                offsets[i] = skipped;
+                continue;
+            }
+
+            if(batches.empty() || batches.back().texture != texture) {
+                batches.push_back(Batch{ texture, end, 0 });
+            }
+
+            offsets[i] = end;
+            batches.back().count += 4;
+            end += 4;
+        }
+
+        vertices.resize(end);
+        jobs.parallelFor(0, count, [this, first, &offsets](size_t begin, size_t finish) {
+            for(size_t i = begin; i < finish; ++i) {
+                if(offsets[i] == skipped) {
+                    continue;
+                }
+
+                const AnimatedSprite& sprite = first[i];
+                const sf::Vertex* quad = sprite.getVertices();
+                const sf::Transform& transform = sprite.getTransform();
+                sf::Vertex* out = &vertices[offsets[i]];
+
+                for(unsigned j = 0; j < 4; ++j) {
+                    out[j] = quad[j];
+                    out[j].position = transform.transformPoint(quad[j].position);
+                }
+            }
+        }, grain);
+    }
+
+    // Queues the collected quads instead of drawing them directly.
+    // Each run sharing a texture becomes one command.
+    void submit(RenderQueue& queue, std::uint8_t layer, std::uint32_t depth = 0) const {
+        for(auto&& batch : batches) {
+            sf::RenderStates states(batch.texture);
+            queue.submit(layer, &vertices[batch.first], batch.count, sf::Quads, states, depth);
+        }
+    }
+
+    size_t getQuadCount() const noexcept {
+        return vertices.size() / 4;
+    }
+
+    // The number of draw calls drawing the batch takes.
+    size_t getDrawCount() const noexcept {
+        return batches.size();
+    }
+};
+} // sky
+
+#endif // SKY_SPRITEBATCH_HPP
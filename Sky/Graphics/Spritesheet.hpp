@@ -24,9 +24,13 @@
 #define SKY_SPRITESHEET_HPP
 
 #include <SFML/Graphics/Texture.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <string>
+#include <unordered_map>
 #include <utility>
 #include <stdexcept>
 #include <type_traits>
+#include <vector>
 
 // Circumvent including "unnecessary" dependencies.
 namespace sf {
@@ -36,15 +40,30 @@ class Sprite;
 namespace sky {
 class Animation;
 
+// What packing tools record about a sprite besides its rect. Trimmed
+// sprites had transparent borders cut off: offset is where the rect sits
+// inside the original sourceSize. Rotated sprites are stored turned 90
+// degrees clockwise, so their rect has width and height swapped.
+struct SpriteInfo {
+    std::string name;
+    sf::Vector2i offset;
+    sf::Vector2i sourceSize;
+    sf::Vector2f pivot;
+    bool rotated = false;
+};
+
 class Spritesheet {
 private:
     const sf::Texture* data = nullptr;
     std::vector<sf::IntRect> sprites;
+    std::vector<SpriteInfo> info;
+    std::unordered_map<std::string, unsigned> names;
+    std::string imagePath;
 public:
     Spritesheet() noexcept = default;
 
-    explicit Spritesheet(const sf::Texture& tex, unsigned width, unsigned height, unsigned spacing = 0): data(&tex) {
-        setSpriteSize(width, height, spacing);
+    explicit Spritesheet(const sf::Texture& tex, unsigned width, unsigned height, unsigned spacing = 0, unsigned margin = 0): data(&tex) {
+        setSpriteSize(width, height, spacing, margin);
     }
 
     auto operator[](unsigned index) noexcept -> decltype(sprites[0]) {
@@ -69,23 +88,79 @@ public:
 
     void setTexture(const sf::Texture& texture) noexcept {
         data = &texture;
+        clear();
+    }
+
+    // Removes every sprite but keeps the texture.
+    void clear() noexcept {
         sprites.clear();
+        info.clear();
+        names.clear();
+        imagePath.clear();
     }
 
-    void setSpriteSize(unsigned width, unsigned height, unsigned spacing = 0) {
+    void addSprite(const sf::IntRect& rect) {
+        SpriteInfo sprite;
+        sprite.sourceSize = sf::Vector2i(rect.width, rect.height);
+        addSprite(rect, std::move(sprite));
+    }
+
+    void addSprite(const sf::IntRect& rect, SpriteInfo sprite) {
+        if(!sprite.name.empty()) {
+            names.emplace(sprite.name, static_cast<unsigned>(sprites.size()));
+        }
+
+        sprites.push_back(rect);
+        info.push_back(std::move(sprite));
+    }
+
+    // margin is the border around the whole texture, spacing the gap between sprites.
+    void setSpriteSize(unsigned width, unsigned height, unsigned spacing = 0, unsigned margin = 0) {
         if(data == nullptr) {
             throw std::logic_error("No texture is set");
         }
 
         auto size = data->getSize();
 
-        for(unsigned y = 0; y < size.y; y += height + spacing) {
-            for(unsigned x = 0; x < size.x; x += width + spacing) {
-                sprites.emplace_back(x, y, width, height);
+        for(unsigned y = margin; y + margin < size.y; y += height + spacing) {
+            for(unsigned x = margin; x + margin < size.x; x += width + spacing) {
+                addSprite(sf::IntRect(x, y, width, height));
             }
         }
     }
 
+    // The image the loaded descriptor refers to, relative to it.
+    // See SpritesheetLoader.
+    const std::string& getImagePath() const noexcept {
+        return imagePath;
+    }
+
+    void setImagePath(std::string path) {
+        imagePath = std::move(path);
+    }
+
+    const SpriteInfo& getInfo(unsigned index) const {
+        if(index >= info.size()) {
+            throw std::out_of_range("Index exceeds number of sprites");
+        }
+
+        return info[index];
+    }
+
+    bool contains(const std::string& name) const {
+        return names.count(name) != 0;
+    }
+
+    unsigned getIndex(const std::string& name) const {
+        auto it = names.find(name);
+
+        if(it == names.end()) {
+            throw std::out_of_range("No sprite named " + name);
+        }
+
+        return it->second;
+    }
+
     template<class T = Animation, typename... Args>
     T createAnimation(Args && ... indices) {
         static_assert(sizeof(T), "Incomplete type. Did you forget to include <Sky/Graphics/Animation.hpp>?");
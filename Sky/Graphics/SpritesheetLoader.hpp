@@ -0,0 +1,323 @@
+// The zlib/libpng License
+
+// Copyright (c) 2014 Danny Y., Rapptz
+
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+
+// Permission is granted to anyone to use this software for any purpose, including
+// commercial applications, and to alter it and redistribute it freely, subject to
+// the following restrictions:
+
+// 1. The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software. If you use this software in a product,
+// an acknowledgment in the product documentation would be appreciated but is
+// not required.
+
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef SKY_SPRITESHEETLOADER_HPP
+#define SKY_SPRITESHEETLOADER_HPP
+
+#include "Spritesheet.hpp"
+#include "../Utility/ContentHash.hpp"
+#include "../Utility/JSON.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifndef SKY_COMPILE_PUGIXML
+#define PUGIXML_HEADER_ONLY
+#include "../libs/pugixml.cpp"
+#endif
+
+#include "../libs/pugixml.hpp"
+
+namespace sky {
+// Fills a Spritesheet from the atlas descriptors written by packing tools:
+// TexturePacker and Aseprite JSON exports and TexturePacker/Starling XML.
+// Kept apart from Spritesheet so only users of it pull in the parsers.
+class SpritesheetLoader {
+private:
+    static constexpr std::uint32_t cacheVersion = 1;
+
+    struct Parsed {
+        std::vector<sf::IntRect> sprites;
+        std::vector<SpriteInfo> info;
+        std::string imagePath;
+
+        void add(const sf::IntRect& rect, SpriteInfo sprite) {
+            sprites.push_back(rect);
+            info.push_back(std::move(sprite));
+        }
+    };
+
+    static void assign(Spritesheet& sheet, Parsed& parsed) {
+        sheet.clear();
+
+        for(size_t i = 0; i < parsed.sprites.size(); ++i) {
+            sheet.addSprite(parsed.sprites[i], std::move(parsed.info[i]));
+        }
+
+        sheet.setImagePath(std::move(parsed.imagePath));
+    }
+
+    // TexturePacker and Aseprite both write frames either as an object
+    // keyed by name or as an array of objects with a filename field.
+    static bool parseJSON(const std::string& text, Parsed& parsed) {
+        json::Value document;
+
+        if(!json::parse(text, document) || !document.isObject()) {
+            return false;
+        }
+
+        auto&& frames = document["frames"];
+        auto add = [&parsed](const std::string& name, const json::Value& frame) {
+            auto&& rect = frame["frame"];
+            auto&& trimmed = frame["spriteSourceSize"];
+            auto&& source = frame["sourceSize"];
+            SpriteInfo sprite;
+            sprite.name = name;
+            sprite.rotated = frame["rotated"].asBool();
+            sf::IntRect area(rect["x"].asInt(), rect["y"].asInt(), rect["w"].asInt(), rect["h"].asInt());
+            sprite.offset = sf::Vector2i(trimmed["x"].asInt(), trimmed["y"].asInt());
+            sprite.sourceSize = sf::Vector2i(source["w"].asInt(area.width), source["h"].asInt(area.height));
+            sprite.pivot = sf::Vector2f(frame["pivot"]["x"].asNumber(), frame["pivot"]["y"].asNumber());
+
+            if(sprite.rotated) {
+                std::swap(area.width, area.height);
+            }
+
+            parsed.add(area, std::move(sprite));
+        };
+
+        if(frames.isArray()) {
+            for(auto&& frame : frames.getElements()) {
+                add(frame["filename"].asString(), frame);
+            }
+        }
+        else if(frames.isObject()) {
+            for(auto&& frame : frames.getMembers()) {
+                add(frame.first, frame.second);
+            }
+        }
+        else {
+            return false;
+        }
+
+        parsed.imagePath = document["meta"]["image"].asString();
+        return true;
+    }
+
+    // TexturePacker's generic XML (<sprite n x y w h oX oY oW oH pX pY r>)
+    // and the Starling/Sparrow format (<SubTexture name x y width height ...>).
+    static bool parseXML(const std::string& text, Parsed& parsed) {
+        pugi::xml_document document;
+
+        if(!document.load_buffer(text.data(), text.size())) {
+            return false;
+        }
+
+        auto atlas = document.child("TextureAtlas");
+
+        if(!atlas) {
+            return false;
+        }
+
+        parsed.imagePath = atlas.attribute("imagePath").as_string();
+
+        for(auto node = atlas.child("sprite"); node; node = node.next_sibling("sprite")) {
+            SpriteInfo sprite;
+            sprite.name = node.attribute("n").as_string();
+            sprite.rotated = std::strcmp(node.attribute("r").as_string(), "y") == 0;
+            sf::IntRect area(node.attribute("x").as_int(), node.attribute("y").as_int(),
+                             node.attribute("w").as_int(), node.attribute("h").as_int());
+            sprite.offset = sf::Vector2i(node.attribute("oX").as_int(), node.attribute("oY").as_int());
+            sprite.sourceSize = sf::Vector2i(node.attribute("oW").as_int(area.width), node.attribute("oH").as_int(area.height));
+            sprite.pivot = sf::Vector2f(node.attribute("pX").as_float(), node.attribute("pY").as_float());
+
+            if(sprite.rotated) {
+                std::swap(area.width, area.height);
+            }
+
+            parsed.add(area, std::move(sprite));
+        }
+
+        for(auto node = atlas.child("SubTexture"); node; node = node.next_sibling("SubTexture")) {
+            SpriteInfo sprite;
+            sprite.name = node.attribute("name").as_string();
+            sprite.rotated = node.attribute("rotated").as_bool();
+            sf::IntRect area(node.attribute("x").as_int(), node.attribute("y").as_int(),
+                             node.attribute("width").as_int(), node.attribute("height").as_int());
+            sprite.offset = sf::Vector2i(-node.attribute("frameX").as_int(), -node.attribute("frameY").as_int());
+            sprite.sourceSize = sf::Vector2i(node.attribute("frameWidth").as_int(area.width),
+                                             node.attribute("frameHeight").as_int(area.height));
+
+            // Starling pivots are in pixels.
+            if(sprite.sourceSize.x != 0 && sprite.sourceSize.y != 0) {
+                sprite.pivot = sf::Vector2f(node.attribute("pivotX").as_float() / sprite.sourceSize.x,
+                                            node.attribute("pivotY").as_float() / sprite.sourceSize.y);
+            }
+
+            parsed.add(area, std::move(sprite));
+        }
+
+        return true;
+    }
+
+    static bool parse(const std::string& text, Parsed& parsed) {
+        auto first = text.find_first_not_of(" \t\r\n");
+        return first != std::string::npos && text[first] == '<' ? parseXML(text, parsed) : parseJSON(text, parsed);
+    }
+
+    template<typename T>
+    static void write(std::ofstream& out, const T& value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template<typename T>
+    static bool read(std::ifstream& in, T& value) {
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+
+    static void write(std::ofstream& out, const std::string& str) {
+        write(out, static_cast<std::uint32_t>(str.size()));
+        out.write(str.data(), str.size());
+    }
+
+    static bool read(std::ifstream& in, std::string& str) {
+        std::uint32_t size;
+
+        if(!read(in, size) || size > (1u << 20)) {
+            return false;
+        }
+
+        str.resize(size);
+        return size == 0 || static_cast<bool>(in.read(&str[0], size));
+    }
+
+    // The sidecar stores the hash of the descriptor it was made from
+    // and is ignored once that no longer matches.
+    static bool loadCache(const std::string& filename, std::uint64_t hash, Parsed& parsed) {
+        std::ifstream in(filename, std::ios::binary);
+        char magic[4];
+        std::uint32_t version;
+        std::uint64_t source;
+        std::uint32_t count;
+
+        if(!in.read(magic, 4) || std::memcmp(magic, "SKYS", 4) != 0 || !read(in, version) || version != cacheVersion ||
+           !read(in, source) || source != hash || !read(in, parsed.imagePath) || !read(in, count)) {
+            return false;
+        }
+
+        for(std::uint32_t i = 0; i < count; ++i) {
+            sf::IntRect rect;
+            SpriteInfo sprite;
+            std::uint8_t rotated;
+
+            if(!read(in, rect.left) || !read(in, rect.top) || !read(in, rect.width) || !read(in, rect.height) ||
+               !read(in, sprite.offset.x) || !read(in, sprite.offset.y) || !read(in, sprite.sourceSize.x) ||
+               !read(in, sprite.sourceSize.y) || !read(in, sprite.pivot.x) || !read(in, sprite.pivot.y) ||
+               !read(in, rotated) || !read(in, sprite.name)) {
+                return false;
+            }
+
+            sprite.rotated = rotated != 0;
+            parsed.add(rect, std::move(sprite));
+        }
+
+        return true;
+    }
+
+    static bool saveCache(const std::string& filename, std::uint64_t hash, const Parsed& parsed) {
+        std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+        out.write("SKYS", 4);
+        write(out, static_cast<std::uint32_t>(cacheVersion));
+        write(out, hash);
+        write(out, parsed.imagePath);
+        write(out, static_cast<std::uint32_t>(parsed.sprites.size()));
+
+        for(size_t i = 0; i < parsed.sprites.size(); ++i) {
+            auto&& rect = parsed.sprites[i];
+            auto&& sprite = parsed.info[i];
+            write(out, rect.left);
+            write(out, rect.top);
+            write(out, rect.width);
+            write(out, rect.height);
+            write(out, sprite.offset.x);
+            write(out, sprite.offset.y);
+            write(out, sprite.sourceSize.x);
+            write(out, sprite.sourceSize.y);
+            write(out, sprite.pivot.x);
+            write(out, sprite.pivot.y);
+            write(out, static_cast<std::uint8_t>(sprite.rotated));
+            write(out, sprite.name);
+        }
+
+        // Don't leave a truncated sidecar behind.
+        if(!out) {
+            out.close();
+            std::remove(filename.c_str());
+            return false;
+        }
+
+        return true;
+    }
+public:
+    // Replaces the sheet's sprites with the frames in the descriptor. The
+    // texture isn't loaded, see Spritesheet::getImagePath().
+    //
+    // The parsed frames are cached in a binary sidecar named filename + ".cache"
+    // in the descriptor's directory, and later loads read it instead of
+    // parsing until the descriptor changes. Failing to write the sidecar,
+    // e.g. in a read-only directory, is ignored and only costs parsing again.
+    static bool loadFromFile(Spritesheet& sheet, const std::string& filename) {
+        std::ifstream in(filename, std::ios::binary);
+
+        if(!in) {
+            return false;
+        }
+
+        std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        std::uint64_t hash = xxh64(text.data(), text.size());
+        std::string cache = filename + ".cache";
+        Parsed parsed;
+
+        if(!loadCache(cache, hash, parsed)) {
+            parsed = Parsed();
+
+            if(!parse(text, parsed)) {
+                return false;
+            }
+
+            saveCache(cache, hash, parsed);
+        }
+
+        assign(sheet, parsed);
+        return true;
+    }
+
+    // Same as loadFromFile with the descriptor's contents, without caching.
+    static bool loadFromMemory(Spritesheet& sheet, const std::string& descriptor) {
+        Parsed parsed;
+
+        if(!parse(descriptor, parsed)) {
+            return false;
+        }
+
+        assign(sheet, parsed);
+        return true;
+    }
+};
+} // sky
+
+#endif // SKY_SPRITESHEETLOADER_HPP
@@ -0,0 +1,542 @@
+// The zlib/libpng License
+
+// Copyright (c) 2014 Danny Y., Rapptz
+
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+
+// Permission is granted to anyone to use this software for any purpose, including
+// commercial applications, and to alter it and redistribute it freely, subject to
+// the following restrictions:
+
+// 1. The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software. If you use this software in a product,
+// an acknowledgment in the product documentation would be appreciated but is
+// not required.
+
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef SKY_TEXTUREATLAS_HPP
+#define SKY_TEXTUREATLAS_HPP
+
+#include "Animation.hpp"
+#include "ResourceLoader.hpp"
+#include "Spritesheet.hpp"
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/Graphics/Texture.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sky {
+// Bottom left skyline rectangle packer.
+class SkylinePacker {
+private:
+    struct Node {
+        unsigned x;
+        unsigned y;
+        unsigned width;
+    };
+
+    std::vector<Node> skyline;
+    unsigned width;
+    unsigned height;
+
+    // The lowest y a rectangle starting at the node can be placed at.
+    bool fit(size_t index, unsigned w, unsigned h, unsigned& y) const {
+        if(skyline[index].x + w > width) {
+            return false;
+        }
+
+        y = 0;
+
+        for(unsigned covered = 0; covered < w; covered += skyline[index++].width) {
+            y = std::max(y, skyline[index].y);
+
+            if(y + h > height) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+public:
+    SkylinePacker(unsigned width, unsigned height): skyline{ Node{ 0, 0, width } }, width(width), height(height) {}
+
+    bool insert(unsigned w, unsigned h, sf::Vector2u& position) {
+        size_t best = skyline.size();
+        unsigned bestTop = height + 1;
+        unsigned bestWidth = width + 1;
+
+        for(size_t i = 0; i < skyline.size(); ++i) {
+            unsigned y;
+
+            if(fit(i, w, h, y) && (y + h < bestTop || (y + h == bestTop && skyline[i].width < bestWidth))) {
+                best = i;
+                bestTop = y + h;
+                bestWidth = skyline[i].width;
+                position = sf::Vector2u(skyline[i].x, y);
+            }
+        }
+
+        if(best == skyline.size()) {
+            return false;
+        }
+
+        skyline.insert(skyline.begin() + best, Node{ position.x, position.y + h, w });
+
+        // Cut away whatever the new node now covers.
+        for(size_t i = best + 1; i < skyline.size();) {
+            unsigned end = skyline[best].x + skyline[best].width;
+
+            if(skyline[i].x >= end) {
+                break;
+            }
+
+            unsigned overlap = end - skyline[i].x;
+
+            if(skyline[i].width <= overlap) {
+                skyline.erase(skyline.begin() + i);
+                continue;
+            }
+
+            skyline[i].x += overlap;
+            skyline[i].width -= overlap;
+            break;
+        }
+
+        for(size_t i = 0; i + 1 < skyline.size();) {
+            if(skyline[i].y == skyline[i + 1].y) {
+                skyline[i].width += skyline[i + 1].width;
+                skyline.erase(skyline.begin() + i + 1);
+            }
+            else {
+                ++i;
+            }
+        }
+
+        return true;
+    }
+};
+
+// Where a packed image ended up. source is the rectangle it was cut from
+// in its original image, rect is the same pixels on the atlas page.
+struct AtlasRegion {
+    unsigned page;
+    sf::IntRect rect;
+    sf::IntRect source;
+};
+
+// A set of packed texture pages. Everything except upload() only touches
+// memory, so an atlas can be built or loaded on a worker thread.
+class TextureAtlas {
+private:
+    friend class AtlasBuilder;
+
+    std::vector<std::unique_ptr<sf::Texture>> textures;
+    std::vector<sf::Image> pages;
+    std::unordered_map<std::string, AtlasRegion> regions;
+
+    void reset(size_t pageCount) {
+        textures.clear();
+        pages.assign(pageCount, sf::Image());
+        regions.clear();
+
+        for(size_t i = 0; i < pageCount; ++i) {
+            textures.emplace_back(new sf::Texture());
+        }
+    }
+
+    bool translate(const AtlasRegion& region, sf::IntRect& rect) const {
+        auto&& source = region.source;
+
+        if(rect.left < source.left || rect.top < source.top || rect.left + rect.width > source.left + source.width ||
+           rect.top + rect.height > source.top + source.height) {
+            return false;
+        }
+
+        rect.left += region.rect.left - source.left;
+        rect.top += region.rect.top - source.top;
+        return true;
+    }
+public:
+    TextureAtlas() = default;
+    TextureAtlas(TextureAtlas&&) = default;
+    TextureAtlas& operator=(TextureAtlas&&) = default;
+
+    // Creates the page textures from the packed images and frees the images.
+    // Has to be called from the thread that owns the OpenGL context.
+    bool upload() {
+        for(size_t i = 0; i < pages.size(); ++i) {
+            if(!textures[i]->loadFromImage(pages[i])) {
+                return false;
+            }
+        }
+
+        pages.clear();
+        return true;
+    }
+
+    // Uploads the pages of a freshly built or loaded atlas into this
+    // atlas's textures, so pointers handed out earlier stay valid.
+    bool replace(TextureAtlas& other) {
+        while(textures.size() < other.pages.size()) {
+            textures.emplace_back(new sf::Texture());
+        }
+
+        for(size_t i = 0; i < other.pages.size(); ++i) {
+            if(!textures[i]->loadFromImage(other.pages[i])) {
+                return false;
+            }
+        }
+
+        pages.clear();
+        regions = std::move(other.regions);
+        return true;
+    }
+
+    size_t getPageCount() const noexcept {
+        return textures.size();
+    }
+
+    // Texture pointers are stable from the moment the atlas is built,
+    // even before upload().
+    const sf::Texture* getTexture(unsigned page) const {
+        return page < textures.size() ? textures[page].get() : nullptr;
+    }
+
+    const AtlasRegion* find(const std::string& name) const {
+        auto it = regions.find(name);
+        return it != regions.end() ? &it->second : nullptr;
+    }
+
+    bool contains(const std::string& name) const {
+        return regions.count(name) != 0;
+    }
+
+    // Rewrites an animation whose frames were cut from the image added under
+    // name so it draws from the atlas instead. Fails without changing the
+    // animation if a frame lies outside of what was packed.
+    bool remap(Animation& animation, const std::string& name) const {
+        auto region = find(name);
+
+        if(region == nullptr) {
+            return false;
+        }
+
+        Animation result(*textures[region->page]);
+
+        for(size_t i = 0; i < animation.getSize(); ++i) {
+            sf::IntRect frame = animation.getFrame(i);
+
+            if(!translate(*region, frame)) {
+                return false;
+            }
+
+            result.addFrame(frame);
+        }
+
+        animation = std::move(result);
+        return true;
+    }
+
+    bool remap(Spritesheet& sheet, const std::string& name) const {
+        auto region = find(name);
+
+        if(region == nullptr) {
+            return false;
+        }
+
+        std::vector<sf::IntRect> sprites;
+        std::vector<SpriteInfo> info;
+
+        for(unsigned i = 0; i < sheet.getNumberOfSprites(); ++i) {
+            sf::IntRect sprite = sheet[i];
+
+            if(!translate(*region, sprite)) {
+                return false;
+            }
+
+            sprites.push_back(sprite);
+            info.push_back(sheet.getInfo(i));
+        }
+
+        sheet.setTexture(*textures[region->page]);
+
+        for(size_t i = 0; i < sprites.size(); ++i) {
+            sheet.addSprite(sprites[i], std::move(info[i]));
+        }
+
+        return true;
+    }
+
+    // Writes an index file along with one PNG per page next to it, so
+    // packing can be done once offline and later runs only load the result.
+    // Must be called before upload(), or on the main thread after it.
+    bool saveToFile(const std::string& filename) const {
+        std::ofstream out(filename);
+
+        if(!out) {
+            return false;
+        }
+
+        auto slash = filename.find_last_of("/\\");
+        std::string base = slash == std::string::npos ? filename : filename.substr(slash + 1);
+        out << "skyatlas 1\n";
+
+        for(size_t i = 0; i < textures.size(); ++i) {
+            std::string image = base + '.' + std::to_string(i) + ".png";
+            sf::Image pixels = i < pages.size() ? pages[i] : textures[i]->copyToImage();
+
+            if(!pixels.saveToFile(filename + '.' + std::to_string(i) + ".png")) {
+                return false;
+            }
+
+            out << "page " << i << ' ' << image << '\n';
+        }
+
+        for(auto&& entry : regions) {
+            auto&& region = entry.second;
+            out << "region " << region.page << ' ' << region.rect.left << ' ' << region.rect.top << ' '
+                << region.rect.width << ' ' << region.rect.height << ' ' << region.source.left << ' '
+                << region.source.top << ' ' << entry.first << '\n';
+        }
+
+        return static_cast<bool>(out);
+    }
+
+    // Loads what saveToFile wrote. Call upload() afterwards.
+    bool loadFromFile(const std::string& filename) {
+        std::ifstream in(filename);
+        std::string magic;
+        int version = 0;
+
+        if(!(in >> magic >> version) || magic != "skyatlas" || version != 1) {
+            return false;
+        }
+
+        auto slash = filename.find_last_of("/\\");
+        std::string directory = slash == std::string::npos ? std::string() : filename.substr(0, slash + 1);
+        std::vector<sf::Image> images;
+        std::unordered_map<std::string, AtlasRegion> loaded;
+        std::string kind;
+
+        while(in >> kind) {
+            if(kind == "page") {
+                size_t index;
+                std::string image;
+
+                if(!(in >> index >> image) || index != images.size()) {
+                    return false;
+                }
+
+                images.emplace_back();
+
+                if(!images.back().loadFromFile(directory + image)) {
+                    return false;
+                }
+            }
+            else if(kind == "region") {
+                AtlasRegion region;
+                std::string name;
+                in >> region.page >> region.rect.left >> region.rect.top >> region.rect.width >> region.rect.height
+                   >> region.source.left >> region.source.top >> std::ws;
+
+                if(!std::getline(in, name) || region.page >= images.size()) {
+                    return false;
+                }
+
+                region.source.width = region.rect.width;
+                region.source.height = region.rect.height;
+                loaded.emplace(std::move(name), region);
+            }
+            else {
+                return false;
+            }
+        }
+
+        reset(images.size());
+        pages = std::move(images);
+        regions = std::move(loaded);
+        return true;
+    }
+};
+
+// Collects images and packs them into a TextureAtlas with as few
+// pages as possible. Padding keeps regions apart and extrusion repeats
+// their border pixels outwards so filtering doesn't bleed in neighbours.
+class AtlasBuilder {
+private:
+    struct Item {
+        std::string name;
+        sf::IntRect source;
+        std::vector<std::uint8_t> pixels;
+    };
+
+    std::vector<Item> items;
+    sf::Vector2u pageSize = sf::Vector2u(2048, 2048);
+    unsigned padding = 2;
+    unsigned extrusion = 1;
+
+    void blit(const Item& item, std::vector<std::uint8_t>& page, unsigned pageWidth, sf::Vector2u position) const {
+        unsigned width = item.source.width;
+        unsigned height = item.source.height;
+        unsigned outerWidth = width + extrusion * 2;
+        unsigned outerHeight = height + extrusion * 2;
+
+        for(unsigned y = 0; y < outerHeight; ++y) {
+            unsigned sourceY = y < extrusion ? 0 : std::min(y - extrusion, height - 1);
+
+            for(unsigned x = 0; x < outerWidth; ++x) {
+                unsigned sourceX = x < extrusion ? 0 : std::min(x - extrusion, width - 1);
+                const std::uint8_t* from = &item.pixels[(sourceX + sourceY * width) * 4];
+                std::uint8_t* to = &page[((position.x + x) + (position.y + y) * pageWidth) * 4];
+                std::copy(from, from + 4, to);
+            }
+        }
+    }
+public:
+    void setPageSize(unsigned width, unsigned height) {
+        pageSize = sf::Vector2u(width, height);
+    }
+
+    void setPadding(unsigned pixels) {
+        padding = pixels;
+    }
+
+    void setExtrusion(unsigned pixels) {
+        extrusion = pixels;
+    }
+
+    // Adds a copy of the rect of image, or all of it if rect is empty.
+    bool add(std::string name, const sf::Image& image, sf::IntRect rect = sf::IntRect()) {
+        auto size = image.getSize();
+
+        if(rect.width == 0 || rect.height == 0) {
+            rect = sf::IntRect(0, 0, size.x, size.y);
+        }
+
+        if(rect.left < 0 || rect.top < 0 || rect.width <= 0 || rect.height <= 0 ||
+           static_cast<unsigned>(rect.left + rect.width) > size.x || static_cast<unsigned>(rect.top + rect.height) > size.y) {
+            return false;
+        }
+
+        Item item{ std::move(name), rect, std::vector<std::uint8_t>(rect.width * rect.height * 4) };
+        const std::uint8_t* pixels = image.getPixelsPtr();
+
+        for(int y = 0; y < rect.height; ++y) {
+            const std::uint8_t* row = pixels + ((rect.top + y) * size.x + rect.left) * 4;
+            std::copy(row, row + rect.width * 4, &item.pixels[y * rect.width * 4]);
+        }
+
+        items.push_back(std::move(item));
+        return true;
+    }
+
+    bool addFile(std::string name, const std::string& filename) {
+        sf::Image image;
+        return image.loadFromFile(filename) && add(std::move(name), image);
+    }
+
+    size_t getSize() const noexcept {
+        return items.size();
+    }
+
+    void clear() {
+        items.clear();
+    }
+
+    // Packs everything added so far. Fails if an image doesn't fit on a page.
+    // Only touches memory, so it may run on a worker thread.
+    bool build(TextureAtlas& atlas) const {
+        std::vector<const Item*> order;
+
+        for(auto&& item : items) {
+            order.push_back(&item);
+        }
+
+        // Tallest first packs noticeably tighter on a skyline.
+        std::stable_sort(order.begin(), order.end(), [](const Item* lhs, const Item* rhs) {
+            return lhs->source.height > rhs->source.height;
+        });
+
+        std::vector<SkylinePacker> packers;
+        std::vector<std::vector<std::uint8_t>> pixels;
+        std::unordered_map<std::string, AtlasRegion> regions;
+        unsigned border = extrusion * 2 + padding;
+
+        for(auto item : order) {
+            unsigned width = item->source.width + border;
+            unsigned height = item->source.height + border;
+            sf::Vector2u position;
+            unsigned page = 0;
+
+            while(page < packers.size() && !packers[page].insert(width, height, position)) {
+                ++page;
+            }
+
+            if(page == packers.size()) {
+                packers.emplace_back(pageSize.x, pageSize.y);
+                pixels.emplace_back(pageSize.x * pageSize.y * 4, 0);
+
+                if(!packers.back().insert(width, height, position)) {
+                    return false;
+                }
+            }
+
+            blit(*item, pixels[page], pageSize.x, position);
+            sf::IntRect rect(position.x + extrusion, position.y + extrusion, item->source.width, item->source.height);
+            regions[item->name] = AtlasRegion{ page, rect, item->source };
+        }
+
+        atlas.reset(pixels.size());
+
+        for(size_t i = 0; i < pixels.size(); ++i) {
+            atlas.pages[i].create(pageSize.x, pageSize.y, pixels[i].data());
+        }
+
+        atlas.regions = std::move(regions);
+        return true;
+    }
+};
+
+// Loads an atlas saved with TextureAtlas::saveToFile.
+template<>
+struct ResourceLoader<TextureAtlas> {
+    using Decoded = std::unique_ptr<TextureAtlas>;
+
+    static Decoded decode(const std::string& filename) {
+        Decoded atlas(new TextureAtlas());
+
+        if(!atlas->loadFromFile(filename)) {
+            atlas.reset();
+        }
+
+        return atlas;
+    }
+
+    static std::shared_ptr<TextureAtlas> create(Decoded& decoded) {
+        if(!decoded || !decoded->upload()) {
+            return nullptr;
+        }
+
+        return std::shared_ptr<TextureAtlas>(std::move(decoded));
+    }
+
+    static bool assign(TextureAtlas& target, Decoded& decoded) {
+        return decoded && target.replace(*decoded);
+    }
+};
+} // sky
+
+#endif // SKY_TEXTUREATLAS_HPP
@@ -8,10 +8,15 @@
 #include <SFML/Graphics/Rect.hpp>
 #include <SFML/System/Vector2.hpp>
 #include <SFML/Graphics/Texture.hpp>
+#include <SFML/Graphics/Image.hpp>
 #include <SFML/Graphics/Drawable.hpp>
 #include <SFML/Graphics/RenderTarget.hpp>
 #include <SFML/Graphics/Transformable.hpp>
 #include <SFML/Graphics/VertexArray.hpp>
+#include "RenderQueue.hpp"
+#include "RenderStats.hpp"
+#include "ResourceLoader.hpp"
+#include "../Concurrency/JobSystem.hpp"
 
 #ifndef SKY_COMPILE_PUGIXML
 #define PUGIXML_HEADER_ONLY
@@ -54,12 +59,17 @@ struct Layer {
     unsigned height = 0;
     unsigned char opacity = 255;
     Layer() = default;
-    void update(unsigned tileWidth, unsigned tileHeight, unsigned firstgid, sf::Vector2u tileInfo) {
-        vertices.setPrimitiveType(sf::Quads);
-        vertices.resize(width * height * 4);
 
-        for(unsigned i = 0; i < width; ++i) {
-            for(unsigned j = 0; j < height; ++j) {
+    // Builds the quads for rows [firstRow, lastRow). vertices must already be sized.
+    void updateRows(unsigned firstRow, unsigned lastRow, unsigned tileWidth, unsigned tileHeight, unsigned firstgid, sf::Vector2u tileInfo) {
+        if(firstRow >= lastRow || width == 0) {
+            return;
+        }
+
+        unsigned columns = tileInfo.x / tileWidth;
+
+        for(unsigned j = firstRow; j < lastRow; ++j) {
+            for(unsigned i = 0; i < width; ++i) {
                 unsigned gid = tiles[i + j * width];
                 sf::Vertex* quad = &vertices[(i + j * width) * 4];
 
@@ -73,8 +83,8 @@ struct Layer {
                     quad[3].color = sf::Color::Transparent;
                 }
 
-                unsigned mod = gid % (tileInfo.x / tileWidth);
-                unsigned div = gid / (tileInfo.x / tileWidth);
+                unsigned mod = gid % columns;
+                unsigned div = gid / columns;
 
                 quad[0].position = sf::Vector2f(i * tileWidth, j * tileHeight);
                 quad[1].position = sf::Vector2f((i + 1) * tileWidth, j * tileHeight);
@@ -88,6 +98,22 @@ struct Layer {
             }
         }
     }
+
+    void update(unsigned tileWidth, unsigned tileHeight, unsigned firstgid, sf::Vector2u tileInfo) {
+        vertices.setPrimitiveType(sf::Quads);
+        vertices.resize(width * height * 4);
+        updateRows(0, height, tileWidth, tileHeight, firstgid, tileInfo);
+    }
+
+    // Same as above with the rows split between the job system's threads.
+    // Each thread writes its own slice of the vertex array.
+    void update(unsigned tileWidth, unsigned tileHeight, unsigned firstgid, sf::Vector2u tileInfo, JobSystem& jobs) {
+        vertices.setPrimitiveType(sf::Quads);
+        vertices.resize(width * height * 4);
+        jobs.parallelFor(0, height, [&](size_t first, size_t last) {
+            updateRows(static_cast<unsigned>(first), static_cast<unsigned>(last), tileWidth, tileHeight, firstgid, tileInfo);
+        });
+    }
 };
 
 struct Tile {
@@ -102,6 +128,7 @@ private:
     std::vector<Object> objects;
     std::vector<Tile> tiles;
     sf::Texture spritesheet;
+    sf::Image tileset;
     unsigned width = 0;
     unsigned height = 0;
     unsigned tileWidth = 0;
@@ -115,6 +142,7 @@ private:
         states.texture = &spritesheet;
 
         for(auto && layer : layers) {
+            RenderStats::Scope scope(RenderStats::Tiles, layer.vertices.getVertexCount(), states.texture);
             target.draw(layer.vertices, states);
         }
     }
@@ -127,7 +155,48 @@ public:
         objects.clear();
     }
 
-    bool loadFromTMX(const std::string& filename) {
+    // Layer vertices are built on the job system's threads when one is given.
+    bool loadFromTMX(const std::string& filename, JobSystem* jobs = nullptr) {
+        return parseTMX(filename, jobs) && uploadTexture();
+    }
+
+    // Moves the tileset decoded by parseTMX into video memory.
+    // Has to be called from the thread that owns the OpenGL context.
+    bool uploadTexture() {
+        bool result = spritesheet.loadFromImage(tileset);
+        tileset = sf::Image();
+        return result;
+    }
+
+    // Takes over the map other parsed with parseTMX and uploads its tileset
+    // into this map's texture, so the transform and the texture pointer
+    // stay the same. Same sized tilesets are updated in place.
+    bool replace(TileMap& other) {
+        if(spritesheet.getSize() == other.tileset.getSize()) {
+            spritesheet.update(other.tileset);
+        }
+        else if(!spritesheet.loadFromImage(other.tileset)) {
+            return false;
+        }
+
+        other.tileset = sf::Image();
+        solidObjects = std::move(other.solidObjects);
+        layers = std::move(other.layers);
+        objects = std::move(other.objects);
+        tiles = std::move(other.tiles);
+        width = other.width;
+        height = other.height;
+        tileWidth = other.tileWidth;
+        tileHeight = other.tileHeight;
+        spacing = other.spacing;
+        margin = other.margin;
+        firstTileID = other.firstTileID;
+        return true;
+    }
+
+    // Does everything loadFromTMX does except for creating the texture,
+    // so it can run on a background thread. Call uploadTexture afterwards.
+    bool parseTMX(const std::string& filename, JobSystem* jobs = nullptr) {
         clear();
 
         pugi::xml_document file;
@@ -158,7 +227,7 @@ public:
         auto imagenode = children.child("image");
         std::string imagePath = imagenode.attribute("source").as_string();
 
-        if(!spritesheet.loadFromFile(imagePath)) {
+        if(!tileset.loadFromFile(imagePath)) {
             return false;
         }
 
@@ -216,8 +285,14 @@ public:
                 }
             }
 
-            layer.update(tileWidth, tileHeight, firstTileID, spritesheet.getSize());
-            layers.push_back(layer);
+            if(jobs != nullptr) {
+                layer.update(tileWidth, tileHeight, firstTileID, tileset.getSize(), *jobs);
+            }
+            else {
+                layer.update(tileWidth, tileHeight, firstTileID, tileset.getSize());
+            }
+
+            layers.push_back(std::move(layer));
         }
 
         // Initialize objects
@@ -293,6 +368,20 @@ public:
         return true;
     }
 
+    // Queues every layer under the given queue layer, in map order.
+    void submit(RenderQueue& queue, std::uint8_t layer, sf::RenderStates states = sf::RenderStates::Default) const {
+        states.transform *= getTransform();
+        states.texture = &spritesheet;
+
+        for(size_t i = 0; i < layers.size(); ++i) {
+            auto&& vertices = layers[i].vertices;
+
+            if(vertices.getVertexCount() != 0) {
+                queue.submit(layer, &vertices[0], vertices.getVertexCount(), sf::Quads, states, static_cast<std::uint32_t>(i));
+            }
+        }
+    }
+
     template<typename Predicate>
     std::vector<Object> getObjects(Predicate pred) const {
         std::vector<Object> result;
@@ -337,6 +426,35 @@ public:
         return false;
     }
 };
+
+// Maps are parsed on the worker thread and
+// only the tileset upload happens in create().
+template<>
+struct ResourceLoader<TileMap> {
+    using Decoded = std::unique_ptr<TileMap>;
+
+    static Decoded decode(const std::string& filename) {
+        Decoded map(new TileMap());
+
+        if(!map->parseTMX(filename)) {
+            map.reset();
+        }
+
+        return map;
+    }
+
+    static std::shared_ptr<TileMap> create(Decoded& decoded) {
+        if(!decoded || !decoded->uploadTexture()) {
+            return nullptr;
+        }
+
+        return std::shared_ptr<TileMap>(std::move(decoded));
+    }
+
+    static bool assign(TileMap& target, Decoded& decoded) {
+        return decoded && target.replace(*decoded);
+    }
+};
 } // sky
 
 #endif // SKY_TILEMAP_HPP
@@ -0,0 +1,240 @@
+// The zlib/libpng License
+
+// Copyright (c) 2014 Danny Y., Rapptz
+
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+
+// Permission is granted to anyone to use this software for any purpose, including
+// commercial applications, and to alter it and redistribute it freely, subject to
+// the following restrictions:
+
+// 1. The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software. If you use this software in a product,
+// an acknowledgment in the product documentation would be appreciated but is
+// not required.
+
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef SKY_SCENESTACK_HPP
+#define SKY_SCENESTACK_HPP
+
+#include "Concurrency/JobSystem.hpp"
+#include <SFML/System/Time.hpp>
+#include <memory>
+#include <vector>
+
+namespace sky {
+class Scene {
+public:
+    virtual ~Scene() = default;
+
+    // Runs on a worker thread while the current scene keeps running.
+    // Parse maps, decode images and build entities into the scene's own
+    // members here; nothing visible to the active scene may be touched.
+    virtual void load() {}
+
+    // Runs on the main thread once load() has returned, once per frame until
+    // it returns true. Each call should only do about budget worth of work,
+    // e.g. a few texture uploads.
+    virtual bool upload(sf::Time budget) {
+        (void)budget;
+        return true;
+    }
+
+    virtual void enter() {}
+    virtual void exit() {}
+
+    virtual void process() {}
+    virtual void update(sf::Time dt) = 0;
+    virtual void render() = 0;
+};
+
+// Stack of scenes where only the top one is processed and updated while
+// every scene is rendered bottom to top. New scenes are loaded through the
+// JobSystem and only swapped in once fully uploaded. Scenes may push, replace
+// and pop from their own callbacks; changes requested while one runs are
+// applied in order once process(), update() or render() returns.
+class SceneStack {
+private:
+    enum class Operation {
+        Push,
+        Replace,
+        Pop
+    };
+
+    struct Transition {
+        std::unique_ptr<Scene> scene;
+        Operation operation;
+        JobCounter loaded;
+    };
+
+    struct Change {
+        std::unique_ptr<Scene> scene;
+        Operation operation;
+    };
+
+    std::vector<std::unique_ptr<Scene>> scenes;
+    std::unique_ptr<Transition> transition;
+    std::vector<Change> deferred;
+    JobSystem* jobs;
+    sf::Time uploadBudget = sf::milliseconds(2);
+    bool dispatching = false;
+
+    void begin(std::unique_ptr<Scene> scene, Operation operation) {
+        finishLoading();
+        transition.reset(new Transition());
+        transition->scene = std::move(scene);
+        transition->operation = operation;
+
+        Scene* target = transition->scene.get();
+        jobs->schedule([target] { target->load(); }, &transition->loaded);
+    }
+
+    void finishLoading() {
+        if(transition) {
+            jobs->wait(transition->loaded);
+
+            while(!transition->scene->upload(uploadBudget)) {}
+
+            swap();
+        }
+    }
+
+    void swap() {
+        Change change{ std::move(transition->scene), transition->operation };
+        transition.reset();
+        apply(std::move(change));
+    }
+
+    void apply(Change change) {
+        deferred.push_back(std::move(change));
+        dispatch([] {});
+    }
+
+    // The scene that gets covered, replaced or popped always exits first,
+    // so enter() and exit() calls alternate for every scene.
+    void perform(Change& change) {
+        if(!scenes.empty()) {
+            scenes.back()->exit();
+
+            if(change.operation != Operation::Push) {
+                scenes.pop_back();
+            }
+        }
+
+        if(change.scene) {
+            scenes.push_back(std::move(change.scene));
+        }
+
+        if(!scenes.empty()) {
+            scenes.back()->enter();
+        }
+    }
+
+    // Keeps scenes alive while their callbacks run. Changes requested
+    // meanwhile, including from enter() and exit(), run afterwards in order.
+    template<typename Function>
+    void dispatch(Function function) {
+        bool outermost = !dispatching;
+        dispatching = true;
+        function();
+
+        if(outermost) {
+            for(size_t i = 0; i < deferred.size(); ++i) {
+                Change change = std::move(deferred[i]);
+                perform(change);
+            }
+
+            deferred.clear();
+            dispatching = false;
+        }
+    }
+public:
+    explicit SceneStack(JobSystem& jobs): jobs(&jobs) {}
+
+    ~SceneStack() {
+        if(transition) {
+            jobs->wait(transition->loaded);
+        }
+    }
+
+    void setUploadBudget(sf::Time budget) {
+        uploadBudget = budget;
+    }
+
+    // Loads the scene in the background and pushes it once ready.
+    // Starting another transition completes the pending one first.
+    void push(std::unique_ptr<Scene> scene) {
+        begin(std::move(scene), Operation::Push);
+    }
+
+    // Loads the scene in the background, then replaces the top scene with it.
+    void replace(std::unique_ptr<Scene> scene) {
+        begin(std::move(scene), Operation::Replace);
+    }
+
+    void pop() {
+        apply(Change{ nullptr, Operation::Pop });
+    }
+
+    bool isLoading() const noexcept {
+        return transition != nullptr;
+    }
+
+    bool empty() const noexcept {
+        return scenes.empty();
+    }
+
+    Scene* top() const noexcept {
+        return scenes.empty() ? nullptr : scenes.back().get();
+    }
+
+    // Blocks until the pending scene is loaded and swapped in. Called from a
+    // scene's callback, the swap itself still waits until that returns.
+    void wait() {
+        finishLoading();
+    }
+
+    void process() {
+        dispatch([this] {
+            if(!scenes.empty()) {
+                scenes.back()->process();
+            }
+        });
+    }
+
+    // Gives the pending scene one upload slice once its background load
+    // is done, swapping it in when it reports completion. Without worker
+    // threads the load runs here instead.
+    void update(sf::Time dt) {
+        if(transition && !transition->loaded.done() && jobs->getWorkerCount() == 0) {
+            jobs->tryRunOne();
+        }
+
+        if(transition && transition->loaded.done() && transition->scene->upload(uploadBudget)) {
+            swap();
+        }
+
+        dispatch([this, dt] {
+            if(!scenes.empty()) {
+                scenes.back()->update(dt);
+            }
+        });
+    }
+
+    void render() {
+        dispatch([this] {
+            for(auto&& scene : scenes) {
+                scene->render();
+            }
+        });
+    }
+};
+} // sky
+
+#endif // SKY_SCENESTACK_HPP
@@ -23,6 +23,13 @@
 #ifndef SKY_UTILITY_HPP
 #define SKY_UTILITY_HPP
 
+#include "Utility/Archive.hpp"
+#include "Utility/ContentHash.hpp"
+#include "Utility/FileWatcher.hpp"
+#include "Utility/FrameArena.hpp"
+#include "Utility/HashedString.hpp"
+#include "Utility/JSON.hpp"
 #include "Utility/Nullable.hpp"
+#include "Utility/TaskScheduler.hpp"
 
 #endif // SKY_UTILITY_HPP
@@ -0,0 +1,406 @@
+// The zlib/libpng License
+
+// Copyright (c) 2014 Danny Y., Rapptz
+
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+
+// Permission is granted to anyone to use this software for any purpose, including
+// commercial applications, and to alter it and redistribute it freely, subject to
+// the following restrictions:
+
+// 1. The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software. If you use this software in a product,
+// an acknowledgment in the product documentation would be appreciated but is
+// not required.
+
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef SKY_ARCHIVE_HPP
+#define SKY_ARCHIVE_HPP
+
+#include "HashedString.hpp"
+#include "LZ4.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#define SKY_ARCHIVE_NO_MMAP
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace sky {
+// Layout of a .skya archive. Integers are stored in the byte order of the
+// machine that wrote it and the table is read in place, so archives only
+// open on machines with the same byte order. Anywhere else the version
+// check fails and openFromFile returns false.
+//
+//   header   magic "SKYA", version, entry count, reserved       (16 bytes)
+//   entries  count * Record sorted by name hash               (48 bytes each)
+//   names    entry names, not null terminated
+//   data     entry contents, each starting on a 16 byte boundary
+namespace detail {
+struct ArchiveHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t count;
+    std::uint32_t reserved;
+};
+
+struct ArchiveRecord {
+    std::uint64_t hash;
+    std::uint64_t offset;
+    std::uint64_t size;
+    std::uint64_t originalSize;
+    std::uint32_t nameOffset;
+    std::uint32_t nameLength;
+    std::uint32_t flags;
+    std::uint32_t reserved;
+};
+
+constexpr std::uint32_t archiveVersion = 1;
+constexpr std::uint32_t archiveCompressed = 1;
+constexpr std::uint64_t archiveAlignment = 16;
+
+// No LZ4 block expands to more than 255 times its compressed size.
+constexpr std::uint64_t archiveMaxRatio = 255;
+} // detail
+
+// A single file inside an Archive. Points straight into the mapping,
+// so it is only valid as long as the Archive it came from.
+class ArchiveEntry {
+private:
+    const char* bytes = nullptr;
+    std::uint64_t stored = 0;
+    std::uint64_t original = 0;
+    bool compressed = false;
+public:
+    ArchiveEntry() = default;
+    ArchiveEntry(const char* bytes, std::uint64_t stored, std::uint64_t original, bool compressed) noexcept:
+    bytes(bytes), stored(stored), original(original), compressed(compressed) {}
+
+    explicit operator bool() const noexcept {
+        return bytes != nullptr;
+    }
+
+    bool isCompressed() const noexcept {
+        return compressed;
+    }
+
+    size_t getSize() const noexcept {
+        return static_cast<size_t>(original);
+    }
+
+    // The stored bytes. Only the contents when not compressed.
+    const char* getData() const noexcept {
+        return bytes;
+    }
+
+    // Returns a pointer to the uncompressed contents. For uncompressed
+    // entries that is the mapping itself and no copy is made, otherwise the
+    // entry is decompressed into buffer. Null if decompression fails.
+    const char* view(std::vector<char>& buffer) const {
+        if(!compressed) {
+            return bytes;
+        }
+
+        buffer.resize(static_cast<size_t>(original));
+
+        if(!lz4::decompress(bytes, static_cast<size_t>(stored), buffer.data(), buffer.size())) {
+            return nullptr;
+        }
+
+        return buffer.data();
+    }
+};
+
+// Read only, memory mapped archive. Lookups binary search the sorted
+// table of contents by name hash.
+class Archive {
+private:
+    const char* base = nullptr;
+    size_t length = 0;
+    const detail::ArchiveRecord* records = nullptr;
+    std::uint32_t count = 0;
+#ifdef SKY_ARCHIVE_NO_MMAP
+    std::vector<char> contents;
+#endif
+
+    void unmap() {
+#ifndef SKY_ARCHIVE_NO_MMAP
+        if(base != nullptr) {
+            munmap(const_cast<char*>(base), length);
+        }
+#endif
+        base = nullptr;
+        length = 0;
+        records = nullptr;
+        count = 0;
+    }
+
+    bool validate() {
+        if(length < sizeof(detail::ArchiveHeader)) {
+            return false;
+        }
+
+        detail::ArchiveHeader header;
+        std::memcpy(&header, base, sizeof(header));
+
+        if(std::memcmp(header.magic, "SKYA", 4) != 0 || header.version != detail::archiveVersion) {
+            return false;
+        }
+
+        if((length - sizeof(header)) / sizeof(detail::ArchiveRecord) < header.count) {
+            return false;
+        }
+
+        auto table = reinterpret_cast<const detail::ArchiveRecord*>(base + sizeof(header));
+
+        for(std::uint32_t i = 0; i < header.count; ++i) {
+            auto&& record = table[i];
+
+            if(record.offset > length || record.size > length - record.offset ||
+               record.nameOffset > length || record.nameLength > length - record.nameOffset) {
+                return false;
+            }
+
+            // Uncompressed entries are read straight from the mapping, so the
+            // size handed out must be the stored size. Compressed ones are
+            // decompressed into a buffer of originalSize bytes, which must be
+            // plausible before anything gets allocated.
+            if((record.flags & detail::archiveCompressed) != 0) {
+                if(record.originalSize / detail::archiveMaxRatio > record.size) {
+                    return false;
+                }
+            }
+            else if(record.originalSize != record.size) {
+                return false;
+            }
+        }
+
+        records = table;
+        count = header.count;
+        return true;
+    }
+public:
+    Archive() = default;
+    Archive(const Archive&) = delete;
+    Archive& operator=(const Archive&) = delete;
+
+    ~Archive() {
+        unmap();
+    }
+
+    bool openFromFile(const std::string& filename) {
+        unmap();
+#ifdef SKY_ARCHIVE_NO_MMAP
+        std::ifstream in(filename, std::ios::binary);
+
+        if(!in) {
+            return false;
+        }
+
+        contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        base = contents.data();
+        length = contents.size();
+#else
+        int fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+
+        if(fd == -1) {
+            return false;
+        }
+
+        struct stat info;
+
+        if(fstat(fd, &info) != 0 || info.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+
+        void* mapping = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+
+        if(mapping == MAP_FAILED) {
+            return false;
+        }
+
+        base = static_cast<const char*>(mapping);
+        length = static_cast<size_t>(info.st_size);
+#endif
+        if(!validate()) {
+            unmap();
+            return false;
+        }
+
+        return true;
+    }
+
+    bool isOpen() const noexcept {
+        return base != nullptr;
+    }
+
+    size_t getEntryCount() const noexcept {
+        return count;
+    }
+
+    // Null entry if name is not in the archive.
+    ArchiveEntry find(const HashedString& name) const {
+        auto end = records + count;
+        auto it = std::lower_bound(records, end, name.hash(), [](const detail::ArchiveRecord& record, std::uint64_t hash) {
+            return record.hash < hash;
+        });
+
+        for(; it != end && it->hash == name.hash(); ++it) {
+            if(it->nameLength == name.size() && std::memcmp(base + it->nameOffset, name.data(), name.size()) == 0) {
+                return ArchiveEntry(base + it->offset, it->size, it->originalSize, (it->flags & detail::archiveCompressed) != 0);
+            }
+        }
+
+        return ArchiveEntry();
+    }
+
+    bool contains(const HashedString& name) const {
+        return static_cast<bool>(find(name));
+    }
+
+    std::vector<std::string> getNames() const {
+        std::vector<std::string> result;
+        result.reserve(count);
+
+        for(std::uint32_t i = 0; i < count; ++i) {
+            result.emplace_back(base + records[i].nameOffset, records[i].nameLength);
+        }
+
+        return result;
+    }
+};
+
+// Builds .skya archives.
+class ArchiveWriter {
+private:
+    struct File {
+        std::string name;
+        std::vector<char> data;
+    };
+
+    std::vector<File> files;
+
+    static void pad(std::vector<char>& out, std::uint64_t alignment) {
+        while(out.size() % alignment != 0) {
+            out.push_back('\0');
+        }
+    }
+public:
+    void add(std::string name, const void* data, size_t size) {
+        auto bytes = static_cast<const char*>(data);
+        files.push_back(File{ std::move(name), std::vector<char>(bytes, bytes + size) });
+    }
+
+    bool addFile(std::string name, const std::string& filename) {
+        std::ifstream in(filename, std::ios::binary);
+
+        if(!in) {
+            return false;
+        }
+
+        std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        files.push_back(File{ std::move(name), std::move(data) });
+        return true;
+    }
+
+    size_t getFileCount() const noexcept {
+        return files.size();
+    }
+
+    // Entries are compressed with LZ4 when asked to and when it actually
+    // makes them smaller. Formats that are already compressed, like PNG,
+    // usually end up stored as is.
+    bool saveToFile(const std::string& filename, bool compress = true) const {
+        std::vector<const File*> sorted;
+
+        for(auto&& file : files) {
+            sorted.push_back(&file);
+        }
+
+        std::sort(sorted.begin(), sorted.end(), [](const File* lhs, const File* rhs) {
+            return fnv1a(lhs->name.data(), lhs->name.size()) < fnv1a(rhs->name.data(), rhs->name.size());
+        });
+
+        std::vector<detail::ArchiveRecord> records(sorted.size());
+        std::vector<char> names;
+        std::vector<char> data;
+
+        for(size_t i = 0; i < sorted.size(); ++i) {
+            auto&& file = *sorted[i];
+            auto&& record = records[i];
+            std::memset(&record, 0, sizeof(record));
+            record.hash = fnv1a(file.name.data(), file.name.size());
+            record.originalSize = file.data.size();
+            record.nameOffset = static_cast<std::uint32_t>(names.size());
+            record.nameLength = static_cast<std::uint32_t>(file.name.size());
+            names.insert(names.end(), file.name.begin(), file.name.end());
+
+            pad(data, detail::archiveAlignment);
+            record.offset = data.size();
+
+            std::vector<unsigned char> packed;
+
+            if(compress && !file.data.empty()) {
+                packed = lz4::compress(file.data.data(), file.data.size());
+            }
+
+            if(!packed.empty() && packed.size() < file.data.size()) {
+                record.flags = detail::archiveCompressed;
+                record.size = packed.size();
+                data.insert(data.end(), packed.begin(), packed.end());
+            }
+            else {
+                record.size = file.data.size();
+                data.insert(data.end(), file.data.begin(), file.data.end());
+            }
+        }
+
+        detail::ArchiveHeader header;
+        std::memcpy(header.magic, "SKYA", 4);
+        header.version = detail::archiveVersion;
+        header.count = static_cast<std::uint32_t>(records.size());
+        header.reserved = 0;
+
+        std::uint64_t namesStart = sizeof(header) + records.size() * sizeof(detail::ArchiveRecord);
+        std::uint64_t dataStart = namesStart + names.size();
+        dataStart += (detail::archiveAlignment - dataStart % detail::archiveAlignment) % detail::archiveAlignment;
+
+        for(auto&& record : records) {
+            record.nameOffset += static_cast<std::uint32_t>(namesStart);
+            record.offset += dataStart;
+        }
+
+        std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(detail::ArchiveRecord));
+        out.write(names.data(), names.size());
+
+        for(std::uint64_t i = namesStart + names.size(); i < dataStart; ++i) {
+            out.put('\0');
+        }
+
+        out.write(data.data(), data.size());
+        return static_cast<bool>(out);
+    }
+};
+} // sky
+
+#endif // SKY_ARCHIVE_HPP
@@ -0,0 +1,142 @@
+// The zlib/libpng License
+
+// Copyright (c) 2014 Danny Y., Rapptz
+
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+
+// Permission is granted to anyone to use this software for any purpose, including
+// commercial applications, and to alter it and redistribute it freely, subject to
+// the following restrictions:
+
+// 1. The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software. If you use this software in a product,
+// an acknowledgment in the product documentation would be appreciated but is
+// not required.
+
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef SKY_CONTENTHASH_HPP
+#define SKY_CONTENTHASH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace sky {
+namespace detail {
+constexpr std::uint64_t xxPrime1 = 11400714785074694791ULL;
+constexpr std::uint64_t xxPrime2 = 14029467366897019727ULL;
+constexpr std::uint64_t xxPrime3 = 1609587929392839161ULL;
+constexpr std::uint64_t xxPrime4 = 9650029242287828579ULL;
+constexpr std::uint64_t xxPrime5 = 2870177450012600261ULL;
+
+inline std::uint64_t rotl64(std::uint64_t value, int bits) noexcept {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+inline std::uint64_t read64(const unsigned char* bytes) noexcept {
+    std::uint64_t value = 0;
+
+    for(int i = 7; i >= 0; --i) {
+        value = (value << 8) | bytes[i];
+    }
+
+    return value;
+}
+
+inline std::uint32_t read32(const unsigned char* bytes) noexcept {
+    return static_cast<std::uint32_t>(bytes[0]) | (static_cast<std::uint32_t>(bytes[1]) << 8) |
+           (static_cast<std::uint32_t>(bytes[2]) << 16) | (static_cast<std::uint32_t>(bytes[3]) << 24);
+}
+
+inline std::uint64_t xxRound(std::uint64_t accumulator, std::uint64_t input) noexcept {
+    accumulator += input * xxPrime2;
+    return rotl64(accumulator, 31) * xxPrime1;
+}
+
+inline std::uint64_t xxMerge(std::uint64_t accumulator, std::uint64_t value) noexcept {
+    accumulator ^= xxRound(0, value);
+    return accumulator * xxPrime1 + xxPrime4;
+}
+} // detail
+
+// XXH64. Fast, non cryptographic and the same on every platform.
+inline std::uint64_t xxh64(const void* data, size_t size, std::uint64_t seed = 0) noexcept {
+    using namespace detail;
+    auto bytes = static_cast<const unsigned char*>(data);
+    auto end = bytes + size;
+    std::uint64_t hash;
+
+    if(size >= 32) {
+        std::uint64_t v1 = seed + xxPrime1 + xxPrime2;
+        std::uint64_t v2 = seed + xxPrime2;
+        std::uint64_t v3 = seed;
+        std::uint64_t v4 = seed - xxPrime1;
+
+        for(; end - bytes >= 32; bytes += 32) {
+            v1 = xxRound(v1, read64(bytes));
+            v2 = xxRound(v2, read64(bytes + 8));
+            v3 = xxRound(v3, read64(bytes + 16));
+            v4 = xxRound(v4, read64(bytes + 24));
+        }
+
+        hash = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+        hash = xxMerge(hash, v1);
+        hash = xxMerge(hash, v2);
+        hash = xxMerge(hash, v3);
+        hash = xxMerge(hash, v4);
+    }
+    else {
+        hash = seed + xxPrime5;
+    }
+
+    hash += size;
+
+    for(; end - bytes >= 8; bytes += 8) {
+        hash ^= xxRound(0, read64(bytes));
+        hash = rotl64(hash, 27) * xxPrime1 + xxPrime4;
+    }
+
+    if(end - bytes >= 4) {
+        hash ^= read32(bytes) * xxPrime1;
+        hash = rotl64(hash, 23) * xxPrime2 + xxPrime3;
+        bytes += 4;
+    }
+
+    for(; bytes < end; ++bytes) {
+        hash ^= *bytes * xxPrime5;
+        hash = rotl64(hash, 11) * xxPrime1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= xxPrime2;
+    hash ^= hash >> 29;
+    hash *= xxPrime3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+// Hashes a file's contents with xxh64. Returns false if it can't be read.
+inline bool hashFile(const std::string& filename, std::uint64_t& result) {
+    std::ifstream in(filename, std::ios::binary);
+
+    if(!in) {
+        return false;
+    }
+
+    std::vector<char> buffer((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    result = xxh64(buffer.data(), buffer.size());
+    return true;
+}
+} // sky
+
+#endif // SKY_CONTENTHASH_HPP
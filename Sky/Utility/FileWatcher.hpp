@@ -0,0 +1,258 @@
+// The zlib/libpng License
+
+// Copyright (c) 2014 Danny Y., Rapptz
+
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+
+// Permission is granted to anyone to use this software for any purpose, including
+// commercial applications, and to alter it and redistribute it freely, subject to
+// the following restrictions:
+
+// 1. The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software. If you use this software in a product,
+// an acknowledgment in the product documentation would be appreciated but is
+// not required.
+
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef SKY_FILEWATCHER_HPP
+#define SKY_FILEWATCHER_HPP
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#else
+#include <sys/stat.h>
+#include <ctime>
+#endif
+
+namespace sky {
+// Reports files that changed on disk. On Linux this uses inotify on the
+// containing directories, which also catches editors that save by
+// writing a new file and renaming it over the old one. Elsewhere the
+// modification times are compared on every poll.
+class FileWatcher {
+private:
+    // A directory stays watched for as long as any of its files are.
+    struct Directory {
+        std::unordered_map<std::string, std::string> files; // file name -> filename as passed to add()
+        int descriptor = -1;
+    };
+
+    std::unordered_map<std::string, Directory> directories;
+#ifdef __linux__
+    int fd = -1;
+
+    // inotify hands out the same descriptor for every spelling of a
+    // directory that normalize() can't merge, e.g. through a symlink or an
+    // absolute path, so each descriptor lists every directory using it.
+    std::unordered_map<int, std::vector<std::string>> descriptors;
+#else
+    std::unordered_map<std::string, std::time_t> times;
+
+    static std::time_t modified(const std::string& filename) {
+        struct stat info;
+        return stat(filename.c_str(), &info) == 0 ? info.st_mtime : 0;
+    }
+#endif
+
+    // Lexically normalizes a directory, so e.g. "./a", "a/" and "a/b/.."
+    // are all watched as "a".
+    static std::string normalize(const std::string& path) {
+        std::vector<std::string> parts;
+        bool absolute = !path.empty() && (path[0] == '/' || path[0] == '\\');
+        size_t first = 0;
+
+        while(first <= path.size()) {
+            size_t last = path.find_first_of("/\\", first);
+
+            if(last == std::string::npos) {
+                last = path.size();
+            }
+
+            std::string part = path.substr(first, last - first);
+
+            if(part == "..") {
+                if(!parts.empty() && parts.back() != "..") {
+                    parts.pop_back();
+                }
+                else if(!absolute) {
+                    parts.push_back(part);
+                }
+            }
+            else if(!part.empty() && part != ".") {
+                parts.push_back(part);
+            }
+
+            first = last + 1;
+        }
+
+        std::string result = absolute ? "/" : "";
+
+        for(size_t i = 0; i < parts.size(); ++i) {
+            result += (i == 0 ? "" : "/") + parts[i];
+        }
+
+        return result.empty() ? "." : result;
+    }
+
+    static void split(const std::string& filename, std::string& directory, std::string& name) {
+        auto slash = filename.find_last_of("/\\");
+
+        if(slash == std::string::npos) {
+            directory = ".";
+            name = filename;
+        }
+        else {
+            directory = normalize(slash == 0 ? "/" : filename.substr(0, slash));
+            name = filename.substr(slash + 1);
+        }
+    }
+public:
+    FileWatcher() {
+#ifdef __linux__
+        fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+    }
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    ~FileWatcher() {
+#ifdef __linux__
+        if(fd != -1) {
+            close(fd);
+        }
+#endif
+    }
+
+    bool add(const std::string& filename) {
+        std::string directory;
+        std::string name;
+        split(filename, directory, name);
+
+#ifdef __linux__
+        if(fd == -1) {
+            return false;
+        }
+
+        if(!directories.count(directory)) {
+            int wd = inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+
+            if(wd == -1) {
+                return false;
+            }
+
+            descriptors[wd].push_back(directory);
+            directories[directory].descriptor = wd;
+        }
+#else
+        if(!times.count(filename)) {
+            times[filename] = modified(filename);
+        }
+#endif
+
+        directories[directory].files[name] = filename;
+        return true;
+    }
+
+    void remove(const std::string& filename) {
+        std::string directory;
+        std::string name;
+        split(filename, directory, name);
+
+        auto it = directories.find(directory);
+
+        if(it == directories.end()) {
+            return;
+        }
+
+        it->second.files.erase(name);
+#ifndef __linux__
+        times.erase(filename);
+#endif
+
+        if(!it->second.files.empty()) {
+            return;
+        }
+
+#ifdef __linux__
+        auto users = descriptors.find(it->second.descriptor);
+
+        if(users != descriptors.end()) {
+            auto&& names = users->second;
+            names.erase(std::find(names.begin(), names.end(), directory));
+
+            if(names.empty()) {
+                inotify_rm_watch(fd, users->first);
+                descriptors.erase(users);
+            }
+        }
+#endif
+        directories.erase(it);
+    }
+
+    bool contains(const std::string& filename) const {
+        std::string directory;
+        std::string name;
+        split(filename, directory, name);
+        auto it = directories.find(directory);
+        return it != directories.end() && it->second.files.count(name) != 0;
+    }
+
+    // Filenames, as passed to add(), that changed since the last poll.
+    std::vector<std::string> poll() {
+        std::unordered_set<std::string> changed;
+#ifdef __linux__
+        alignas(inotify_event) char buffer[4096];
+        ssize_t length;
+
+        while(fd != -1 && (length = read(fd, buffer, sizeof(buffer))) > 0) {
+            for(char* ptr = buffer; ptr < buffer + length;) {
+                auto event = reinterpret_cast<const inotify_event*>(ptr);
+                ptr += sizeof(inotify_event) + event->len;
+
+                auto users = descriptors.find(event->wd);
+
+                if(event->len == 0 || users == descriptors.end()) {
+                    continue;
+                }
+
+                for(auto&& directory : users->second) {
+                    auto&& files = directories[directory].files;
+                    auto file = files.find(event->name);
+
+                    if(file != files.end()) {
+                        changed.insert(file->second);
+                    }
+                }
+            }
+        }
+#else
+        for(auto&& pair : times) {
+            std::time_t time = modified(pair.first);
+
+            if(time != pair.second) {
+                pair.second = time;
+                changed.insert(pair.first);
+            }
+        }
+#endif
+        return std::vector<std::string>(changed.begin(), changed.end());
+    }
+};
+} // sky
+
+#endif // SKY_FILEWATCHER_HPP
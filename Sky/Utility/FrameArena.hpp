@@ -0,0 +1,234 @@
+// The zlib/libpng License
+
+// Copyright (c) 2014 Danny Y., Rapptz
+
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+
+// Permission is granted to anyone to use this software for any purpose, including
+// commercial applications, and to alter it and redistribute it freely, subject to
+// the following restrictions:
+
+// 1. The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software. If you use this software in a product,
+// an acknowledgment in the product documentation would be appreciated but is
+// not required.
+
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef SKY_FRAMEARENA_HPP
+#define SKY_FRAMEARENA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace sky {
+// Bump allocator. Memory is handed out linearly and only ever
+// given back all at once through reset(), so deallocation is free.
+// Nothing allocated from it has its destructor called.
+class LinearArena {
+private:
+    struct Block {
+        std::unique_ptr<char[]> data;
+        std::size_t size;
+    };
+
+    std::vector<Block> blocks;
+    std::size_t offset = 0;
+    std::size_t used = 0;
+    std::size_t peak = 0;
+
+    static constexpr std::size_t smallestBlock = 64;
+
+    void grow(std::size_t minimum) {
+        std::size_t size = blocks.empty() ? smallestBlock : blocks.back().size * 2;
+
+        if(size < minimum) {
+            size = minimum;
+        }
+
+        blocks.push_back(Block{ std::unique_ptr<char[]>(new char[size]), size });
+        offset = 0;
+    }
+public:
+    explicit LinearArena(std::size_t capacity = 1 << 20) {
+        grow(capacity);
+    }
+
+    // The moved-from arena is left empty and allocates a new block when next used.
+    LinearArena(LinearArena&& other) noexcept {
+        *this = std::move(other);
+    }
+
+    LinearArena& operator=(LinearArena&& other) noexcept {
+        if(this != &other) {
+            blocks = std::move(other.blocks);
+            offset = other.offset;
+            used = other.used;
+            peak = other.peak;
+            other.blocks.clear();
+            other.offset = 0;
+            other.used = 0;
+            other.peak = 0;
+        }
+
+        return *this;
+    }
+
+    void* allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t)) {
+        if(blocks.empty()) {
+            grow(size + alignment);
+        }
+
+        auto&& block = blocks.back();
+        auto address = reinterpret_cast<std::uintptr_t>(block.data.get()) + offset;
+        std::size_t padding = (alignment - (address % alignment)) % alignment;
+
+        if(offset + padding + size > block.size) {
+            grow(size + alignment);
+            return allocate(size, alignment);
+        }
+
+        offset += padding + size;
+        used += padding + size;
+        return block.data.get() + offset - size;
+    }
+
+    template<typename T, typename... Args>
+    T* create(Args&&... args) {
+        static_assert(std::is_trivially_destructible<T>::value, "LinearArena never calls destructors");
+        return ::new(allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // Releases every allocation at once. If the previous use spilled over
+    // into more than one block they are merged so the next use fits in one.
+    void reset() {
+        if(used > peak) {
+            peak = used;
+        }
+
+        if(blocks.size() > 1) {
+            std::size_t total = 0;
+
+            for(auto&& block : blocks) {
+                total += block.size;
+            }
+
+            blocks.clear();
+            grow(total);
+        }
+
+        offset = 0;
+        used = 0;
+    }
+
+    std::size_t getUsed() const noexcept {
+        return used;
+    }
+
+    std::size_t getPeak() const noexcept {
+        return used > peak ? used : peak;
+    }
+
+    std::size_t getCapacity() const noexcept {
+        std::size_t total = 0;
+
+        for(auto&& block : blocks) {
+            total += block.size;
+        }
+
+        return total;
+    }
+};
+
+// STL compatible adaptor over a LinearArena.
+template<typename T>
+class ArenaAllocator {
+private:
+    template<typename U> friend class ArenaAllocator;
+    LinearArena* arena;
+public:
+    using value_type = T;
+
+    ArenaAllocator(LinearArena& arena) noexcept: arena(&arena) {}
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept: arena(other.arena) {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, std::size_t) noexcept {}
+
+    template<typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept {
+        return arena == other.arena;
+    }
+
+    template<typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const noexcept {
+        return arena != other.arena;
+    }
+};
+
+template<typename T>
+using FrameVector = std::vector<T, ArenaAllocator<T>>;
+
+// Two LinearArenas used in alternation. flip() is called once per frame,
+// so anything allocated this frame stays valid until the end of the next one.
+class FrameArena {
+private:
+    LinearArena arenas[2];
+    unsigned index = 0;
+public:
+    explicit FrameArena(std::size_t capacity = 1 << 20): arenas{ LinearArena(capacity), LinearArena(capacity) } {}
+
+    void flip() {
+        index ^= 1;
+        arenas[index].reset();
+    }
+
+    LinearArena& current() noexcept {
+        return arenas[index];
+    }
+
+    const LinearArena& current() const noexcept {
+        return arenas[index];
+    }
+
+    const LinearArena& previous() const noexcept {
+        return arenas[index ^ 1];
+    }
+
+    void* allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t)) {
+        return current().allocate(size, alignment);
+    }
+
+    template<typename T, typename... Args>
+    T* create(Args&&... args) {
+        return current().create<T>(std::forward<Args>(args)...);
+    }
+
+    template<typename T>
+    ArenaAllocator<T> allocator() noexcept {
+        return ArenaAllocator<T>(current());
+    }
+
+    template<typename T>
+    FrameVector<T> makeVector() {
+        return FrameVector<T>(allocator<T>());
+    }
+};
+} // sky
+
+#endif // SKY_FRAMEARENA_HPP
@@ -0,0 +1,89 @@
+// The zlib/libpng License
+
+// Copyright (c) 2014 Danny Y., Rapptz
+
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+
+// Permission is granted to anyone to use this software for any purpose, including
+// commercial applications, and to alter it and redistribute it freely, subject to
+// the following restrictions:
+
+// 1. The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software. If you use this software in a product,
+// an acknowledgment in the product documentation would be appreciated but is
+// not required.
+
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef SKY_HASHEDSTRING_HPP
+#define SKY_HASHEDSTRING_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+namespace sky {
+// 64-bit FNV-1a. Usable in constant expressions.
+constexpr std::uint64_t fnv1a(const char* str, std::size_t size, std::uint64_t hash = 14695981039346656037ull) {
+    return size == 0 ? hash : fnv1a(str + 1, size - 1, (hash ^ static_cast<unsigned char>(*str)) * 1099511628211ull);
+}
+
+// Length of str up to its first null character or size, whichever comes first.
+constexpr std::size_t boundedLength(const char* str, std::size_t size, std::size_t index = 0) {
+    return index == size || str[index] == '\0' ? index : boundedLength(str, size, index + 1);
+}
+
+// Non-owning string with its hash computed once up front. Constructing one
+// from a literal can happen at compile time, so lookups that use it never
+// hash nor allocate.
+class HashedString {
+private:
+    const char* str;
+    std::size_t length;
+    std::uint64_t value;
+public:
+    template<std::size_t N>
+    constexpr HashedString(const char (&array)[N]) noexcept: HashedString(array, boundedLength(array, N)) {}
+
+    constexpr HashedString(const char* str, std::size_t length) noexcept: str(str), length(length), value(fnv1a(str, length)) {}
+
+    HashedString(const std::string& str) noexcept: HashedString(str.data(), str.size()) {}
+
+    template<typename Pointer, typename = typename std::enable_if<std::is_same<Pointer, const char*>::value ||
+                                                                    std::is_same<Pointer, char*>::value>::type>
+    HashedString(Pointer str) noexcept: HashedString(str, std::strlen(str)) {}
+
+    constexpr const char* data() const noexcept {
+        return str;
+    }
+
+    constexpr std::size_t size() const noexcept {
+        return length;
+    }
+
+    constexpr std::uint64_t hash() const noexcept {
+        return value;
+    }
+
+    std::string toString() const {
+        return std::string(str, length);
+    }
+};
+
+inline bool operator==(const HashedString& lhs, const HashedString& rhs) noexcept {
+    return lhs.hash() == rhs.hash() && lhs.size() == rhs.size() && std::memcmp(lhs.data(), rhs.data(), lhs.size()) == 0;
+}
+
+inline bool operator!=(const HashedString& lhs, const HashedString& rhs) noexcept {
+    return !(lhs == rhs);
+}
+} // sky
+
+#endif // SKY_HASHEDSTRING_HPP
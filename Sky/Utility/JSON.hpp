@@ -0,0 +1,353 @@
+// The zlib/libpng License
+
+// Copyright (c) 2014 Danny Y., Rapptz
+
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+
+// Permission is granted to anyone to use this software for any purpose, including
+// commercial applications, and to alter it and redistribute it freely, subject to
+// the following restrictions:
+
+// 1. The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software. If you use this software in a product,
+// an acknowledgment in the product documentation would be appreciated but is
+// not required.
+
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef SKY_JSON_HPP
+#define SKY_JSON_HPP
+
+#include <cctype>
+#include <cstdlib>
+#include <locale>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace sky {
+namespace json {
+enum class Type {
+    Null,
+    Boolean,
+    Number,
+    String,
+    Array,
+    Object
+};
+
+// A parsed JSON document. Lookups that don't match return a null value
+// instead of throwing, so optional fields can be read with a default.
+class Value {
+private:
+    friend class Parser;
+
+    Type type = Type::Null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string string;
+    std::vector<Value> elements;
+    std::vector<std::pair<std::string, Value>> members;
+
+    static const Value& null() {
+        static const Value value;
+        return value;
+    }
+public:
+    Value() = default;
+
+    Type getType() const noexcept {
+        return type;
+    }
+
+    bool isNull() const noexcept {
+        return type == Type::Null;
+    }
+
+    bool isArray() const noexcept {
+        return type == Type::Array;
+    }
+
+    bool isObject() const noexcept {
+        return type == Type::Object;
+    }
+
+    bool asBool(bool fallback = false) const noexcept {
+        return type == Type::Boolean ? boolean : fallback;
+    }
+
+    double asNumber(double fallback = 0.0) const noexcept {
+        return type == Type::Number ? number : fallback;
+    }
+
+    int asInt(int fallback = 0) const noexcept {
+        return type == Type::Number ? static_cast<int>(number) : fallback;
+    }
+
+    const std::string& asString() const noexcept {
+        static const std::string empty;
+        return type == Type::String ? string : empty;
+    }
+
+    size_t size() const noexcept {
+        return type == Type::Array ? elements.size() : members.size();
+    }
+
+    const Value& operator[](size_t index) const {
+        return index < elements.size() ? elements[index] : null();
+    }
+
+    const Value& operator[](const std::string& key) const {
+        for(auto&& member : members) {
+            if(member.first == key) {
+                return member.second;
+            }
+        }
+
+        return null();
+    }
+
+    bool contains(const std::string& key) const {
+        return !(*this)[key].isNull();
+    }
+
+    const std::vector<Value>& getElements() const noexcept {
+        return elements;
+    }
+
+    // In document order.
+    const std::vector<std::pair<std::string, Value>>& getMembers() const noexcept {
+        return members;
+    }
+};
+
+class Parser {
+private:
+    const char* current;
+    const char* end;
+    unsigned depth = 0;
+
+    void skipWhitespace() {
+        while(current != end && (*current == ' ' || *current == '\t' || *current == '\n' || *current == '\r')) {
+            ++current;
+        }
+    }
+
+    bool consume(char c) {
+        skipWhitespace();
+
+        if(current != end && *current == c) {
+            ++current;
+            return true;
+        }
+
+        return false;
+    }
+
+    bool literal(const char* word) {
+        for(; *word != '\0'; ++word, ++current) {
+            if(current == end || *current != *word) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    static void appendUtf8(std::string& out, unsigned long code) {
+        if(code < 0x80) {
+            out += static_cast<char>(code);
+        }
+        else if(code < 0x800) {
+            out += static_cast<char>(0xC0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+        else if(code < 0x10000) {
+            out += static_cast<char>(0xE0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+        else {
+            out += static_cast<char>(0xF0 | (code >> 18));
+            out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+
+    bool hex(unsigned long& code) {
+        if(end - current < 4) {
+            return false;
+        }
+
+        std::string digits(current, current + 4);
+        char* last;
+        code = std::strtoul(digits.c_str(), &last, 16);
+        current += 4;
+        return last == digits.c_str() + 4;
+    }
+
+    bool parseString(std::string& out) {
+        if(!consume('"')) {
+            return false;
+        }
+
+        while(current != end && *current != '"') {
+            char c = *current++;
+
+            if(c != '\\') {
+                out += c;
+                continue;
+            }
+
+            if(current == end) {
+                return false;
+            }
+
+            switch(*current++) {
+            case '"': out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/': out += '/'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                unsigned long code;
+
+                if(!hex(code)) {
+                    return false;
+                }
+
+                // Surrogate pair
+                if(code >= 0xD800 && code < 0xDC00) {
+                    unsigned long low;
+
+                    if(!literal("\\u") || !hex(low) || low < 0xDC00 || low > 0xDFFF) {
+                        return false;
+                    }
+
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                }
+
+                appendUtf8(out, code);
+                break;
+            }
+            default:
+                return false;
+            }
+        }
+
+        return current++ != end;
+    }
+
+    bool parseNumber(double& out) {
+        const char* start = current;
+
+        while(current != end && (std::isdigit(static_cast<unsigned char>(*current)) || *current == '-' || *current == '+' ||
+                                 *current == '.' || *current == 'e' || *current == 'E')) {
+            ++current;
+        }
+
+        // strtod would follow the global locale's decimal point.
+        std::istringstream digits(std::string(start, current));
+        digits.imbue(std::locale::classic());
+        return start != current && (digits >> out) && digits.eof();
+    }
+
+    bool parseValue(Value& value) {
+        skipWhitespace();
+
+        if(current == end || ++depth > 256) {
+            return false;
+        }
+
+        bool result = true;
+
+        switch(*current) {
+        case '{':
+            value.type = Type::Object;
+            ++current;
+
+            if(!consume('}')) {
+                do {
+                    std::pair<std::string, Value> member;
+                    skipWhitespace();
+                    result = parseString(member.first) && consume(':') && parseValue(member.second);
+                    value.members.push_back(std::move(member));
+                }
+                while(result && consume(','));
+
+                result = result && consume('}');
+            }
+            break;
+        case '[':
+            value.type = Type::Array;
+            ++current;
+
+            if(!consume(']')) {
+                do {
+                    value.elements.emplace_back();
+                    result = parseValue(value.elements.back());
+                }
+                while(result && consume(','));
+
+                result = result && consume(']');
+            }
+            break;
+        case '"':
+            value.type = Type::String;
+            result = parseString(value.string);
+            break;
+        case 't':
+            value.type = Type::Boolean;
+            value.boolean = true;
+            result = literal("true");
+            break;
+        case 'f':
+            value.type = Type::Boolean;
+            result = literal("false");
+            break;
+        case 'n':
+            result = literal("null");
+            break;
+        default:
+            value.type = Type::Number;
+            result = parseNumber(value.number);
+            break;
+        }
+
+        --depth;
+        return result;
+    }
+public:
+    // Returns false on malformed input.
+    bool parse(const std::string& text, Value& result) {
+        current = text.data();
+        end = text.data() + text.size();
+        depth = 0;
+        result = Value();
+
+        if(!parseValue(result)) {
+            return false;
+        }
+
+        skipWhitespace();
+        return current == end;
+    }
+};
+
+inline bool parse(const std::string& text, Value& result) {
+    return Parser().parse(text, result);
+}
+} // json
+} // sky
+
+#endif // SKY_JSON_HPP
@@ -0,0 +1,201 @@
+// The zlib/libpng License
+
+// Copyright (c) 2014 Danny Y., Rapptz
+
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+
+// Permission is granted to anyone to use this software for any purpose, including
+// commercial applications, and to alter it and redistribute it freely, subject to
+// the following restrictions:
+
+// 1. The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software. If you use this software in a product,
+// an acknowledgment in the product documentation would be appreciated but is
+// not required.
+
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef SKY_LZ4_HPP
+#define SKY_LZ4_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace sky {
+namespace lz4 {
+// LZ4 block format, compatible with the reference LZ4_decompress_safe.
+// The compressor is a plain single-probe greedy matcher: fast and simple,
+// not the best ratio.
+namespace detail {
+constexpr std::size_t minMatch = 4;
+constexpr std::size_t lastLiterals = 5;
+constexpr std::size_t matchLimit = 12;
+constexpr unsigned hashBits = 16;
+
+inline std::uint32_t read32(const unsigned char* ptr) {
+    std::uint32_t value;
+    std::memcpy(&value, ptr, sizeof(value));
+    return value;
+}
+
+inline void writeLength(std::vector<unsigned char>& out, std::size_t length) {
+    for(; length >= 255; length -= 255) {
+        out.push_back(255);
+    }
+
+    out.push_back(static_cast<unsigned char>(length));
+}
+
+inline void emit(std::vector<unsigned char>& out, const unsigned char* literals, std::size_t literalLength,
+                 std::size_t offset, std::size_t matchLength) {
+    std::size_t match = matchLength == 0 ? 0 : matchLength - minMatch;
+    unsigned char token = static_cast<unsigned char>(((literalLength < 15 ? literalLength : 15) << 4) | (match < 15 ? match : 15));
+    out.push_back(token);
+
+    if(literalLength >= 15) {
+        writeLength(out, literalLength - 15);
+    }
+
+    out.insert(out.end(), literals, literals + literalLength);
+
+    if(matchLength == 0) {
+        return;
+    }
+
+    out.push_back(static_cast<unsigned char>(offset & 0xFF));
+    out.push_back(static_cast<unsigned char>(offset >> 8));
+
+    if(match >= 15) {
+        writeLength(out, match - 15);
+    }
+}
+} // detail
+
+inline std::size_t compressBound(std::size_t size) {
+    return size + size / 255 + 16;
+}
+
+inline std::vector<unsigned char> compress(const void* data, std::size_t size) {
+    using namespace detail;
+    auto src = static_cast<const unsigned char*>(data);
+    std::vector<unsigned char> out;
+    out.reserve(compressBound(size));
+    std::size_t anchor = 0;
+
+    if(size > matchLimit) {
+        std::vector<std::int64_t> table(std::size_t(1) << hashBits, -1);
+        std::size_t limit = size - matchLimit;
+        std::size_t position = 0;
+
+        while(position < limit) {
+            std::uint32_t sequence = read32(src + position);
+            std::uint32_t hash = (sequence * 2654435761u) >> (32 - hashBits);
+            std::int64_t candidate = table[hash];
+            table[hash] = static_cast<std::int64_t>(position);
+
+            if(candidate < 0 || position - candidate > 65535 || read32(src + candidate) != sequence) {
+                ++position;
+                continue;
+            }
+
+            std::size_t length = minMatch;
+
+            while(position + length < size - lastLiterals && src[candidate + length] == src[position + length]) {
+                ++length;
+            }
+
+            emit(out, src + anchor, position - anchor, position - candidate, length);
+            position += length;
+            anchor = position;
+        }
+    }
+
+    emit(out, src + anchor, size - anchor, 0, 0);
+    return out;
+}
+
+// Decompresses exactly outputSize bytes into output. Returns false on
+// malformed input instead of reading or writing out of bounds.
+inline bool decompress(const void* data, std::size_t size, void* output, std::size_t outputSize) {
+    auto ip = static_cast<const unsigned char*>(data);
+    auto end = ip + size;
+    auto op = static_cast<unsigned char*>(output);
+    auto start = op;
+    auto outputEnd = op + outputSize;
+
+    auto readLength = [&](std::size_t& length) {
+        unsigned char byte;
+
+        do {
+            if(ip >= end) {
+                return false;
+            }
+
+            byte = *ip++;
+            length += byte;
+        }
+        while(byte == 255);
+
+        return true;
+    };
+
+    while(ip < end) {
+        unsigned char token = *ip++;
+        std::size_t literals = token >> 4;
+
+        if(literals == 15 && !readLength(literals)) {
+            return false;
+        }
+
+        if(literals > static_cast<std::size_t>(end - ip) || literals > static_cast<std::size_t>(outputEnd - op)) {
+            return false;
+        }
+
+        std::memcpy(op, ip, literals);
+        ip += literals;
+        op += literals;
+
+        if(ip == end) {
+            break;
+        }
+
+        if(end - ip < 2) {
+            return false;
+        }
+
+        std::size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        std::size_t match = (token & 15);
+
+        if(match == 15 && !readLength(match)) {
+            return false;
+        }
+
+        match += detail::minMatch;
+
+        if(offset == 0 || offset > static_cast<std::size_t>(op - start) || match > static_cast<std::size_t>(outputEnd - op)) {
+            return false;
+        }
+
+        const unsigned char* copy = op - offset;
+
+        for(std::size_t i = 0; i < match; ++i) {
+            op[i] = copy[i];
+        }
+
+        op += match;
+    }
+
+    return op == outputEnd;
+}
+} // lz4
+} // sky
+
+#endif // SKY_LZ4_HPP
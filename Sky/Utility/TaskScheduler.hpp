@@ -0,0 +1,146 @@
+// The zlib/libpng License
+
+// Copyright (c) 2014 Danny Y., Rapptz
+
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+
+// Permission is granted to anyone to use this software for any purpose, including
+// commercial applications, and to alter it and redistribute it freely, subject to
+// the following restrictions:
+
+// 1. The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software. If you use this software in a product,
+// an acknowledgment in the product documentation would be appreciated but is
+// not required.
+
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef SKY_TASKSCHEDULER_HPP
+#define SKY_TASKSCHEDULER_HPP
+
+#include <SFML/System/Clock.hpp>
+#include <SFML/System/Time.hpp>
+#include <deque>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace sky {
+// Cooperative tasks that are resumed in round robin order for as long as
+// a time budget allows. A task does a small slice of work per call and
+// returns true once it has finished.
+class TaskScheduler {
+public:
+    using Task = std::function<bool()>;
+
+    struct FrameStats {
+        sf::Time budget;
+        sf::Time used;
+        unsigned resumed = 0;
+        unsigned completed = 0;
+        unsigned pending = 0;
+    };
+private:
+    std::deque<Task> tasks;
+    std::vector<FrameStats> history;
+    size_t historyIndex = 0;
+    size_t historySize = 0;
+
+    void record(const FrameStats& stats) {
+        if(history.empty()) {
+            return;
+        }
+
+        history[historyIndex] = stats;
+        historyIndex = (historyIndex + 1) % history.size();
+
+        if(historySize < history.size()) {
+            ++historySize;
+        }
+    }
+public:
+    explicit TaskScheduler(size_t historyLength = 120): history(historyLength) {}
+
+    template<typename Callable>
+    void push(Callable&& task) {
+        tasks.emplace_back(std::forward<Callable>(task));
+    }
+
+    void clear() {
+        tasks.clear();
+    }
+
+    bool empty() const noexcept {
+        return tasks.empty();
+    }
+
+    size_t getSize() const noexcept {
+        return tasks.size();
+    }
+
+    FrameStats run(sf::Time budget) {
+        FrameStats stats;
+        stats.budget = budget < sf::Time::Zero ? sf::Time::Zero : budget;
+        sf::Clock clock;
+
+        while(!tasks.empty() && clock.getElapsedTime() < stats.budget) {
+            Task task = std::move(tasks.front());
+            tasks.pop_front();
+            ++stats.resumed;
+
+            if(task()) {
+                ++stats.completed;
+            }
+            else {
+                tasks.push_back(std::move(task));
+            }
+        }
+
+        stats.used = clock.getElapsedTime();
+        stats.pending = tasks.size();
+        record(stats);
+        return stats;
+    }
+
+    // Statistics for the most recent frames, oldest first.
+    std::vector<FrameStats> getHistory() const {
+        std::vector<FrameStats> result;
+        result.reserve(historySize);
+        size_t start = (historyIndex + history.size() - historySize) % (history.empty() ? 1 : history.size());
+
+        for(size_t i = 0; i < historySize; ++i) {
+            result.push_back(history[(start + i) % history.size()]);
+        }
+
+        return result;
+    }
+
+    FrameStats getLastFrame() const {
+        if(historySize == 0) {
+            return FrameStats();
+        }
+
+        return history[(historyIndex + history.size() - 1) % history.size()];
+    }
+
+    // Fraction of the offered budget that was spent over the recorded frames.
+    float getAverageUsage() const {
+        sf::Time budget;
+        sf::Time used;
+
+        for(auto&& stats : getHistory()) {
+            budget += stats.budget;
+            used += stats.used;
+        }
+
+        return budget == sf::Time::Zero ? 0.f : used.asSeconds() / budget.asSeconds();
+    }
+};
+} // sky
+
+#endif // SKY_TASKSCHEDULER_HPP
@@ -0,0 +1,258 @@
+// The zlib/libpng License
+
+// Copyright (c) 2014 Danny Y., Rapptz
+
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+
+// Permission is granted to anyone to use this software for any purpose, including
+// commercial applications, and to alter it and redistribute it freely, subject to
+// the following restrictions:
+
+// 1. The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software. If you use this software in a product,
+// an acknowledgment in the product documentation would be appreciated but is
+// not required.
+
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+
+// 3. This notice may not be removed or altered from any source distribution.
+
+// Rough benchmark comparing reads from a .skya archive against reading the
+// same files from disk one by one, both as raw bytes and through
+// ResourceCache::load with a loader that keeps the bytes, so the cache's
+// decode path is timed without any image decoding on top.
+// Build with e.g. g++ -std=c++11 -O2 -I. tools/archivebench.cpp -o archivebench -lsfml-system
+//
+// usage: archivebench archive.skya [directory]
+// With a directory, every entry is also read from directory/name. Each
+// measurement runs twice. Before the first run the files are evicted from
+// the page cache with posix_fadvise, so it has to read from disk. The
+// second run reads from the page cache. Eviction needs no privileges but is
+// only a hint, and it is skipped on Windows, where both runs are warm.
+
+#include <Sky/Graphics/ResourceCache.hpp>
+#include <Sky/Utility/Archive.hpp>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Drops the file's pages from the page cache. The file must not be mapped.
+void evict(const std::string& filename) {
+#if !defined(_WIN32)
+    int fd = ::open(filename.c_str(), O_RDONLY);
+
+    if(fd != -1) {
+        ::fdatasync(fd);
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        ::close(fd);
+    }
+#else
+    (void)filename;
+#endif
+}
+
+// Reads the whole file with one read call.
+bool readFile(const std::string& filename, std::vector<char>& bytes) {
+    std::ifstream in(filename, std::ios::binary | std::ios::ate);
+
+    if(!in) {
+        return false;
+    }
+
+    bytes.resize(static_cast<size_t>(in.tellg()));
+    in.seekg(0);
+    return static_cast<bool>(in.read(bytes.data(), static_cast<std::streamsize>(bytes.size())));
+}
+
+// Keeps the bytes exactly as stored.
+struct Blob {
+    std::vector<char> bytes;
+
+    bool loadFromFile(const std::string& filename) {
+        return readFile(filename, bytes);
+    }
+
+    bool loadFromMemory(const void* data, size_t size) {
+        bytes.assign(static_cast<const char*>(data), static_cast<const char*>(data) + size);
+        return true;
+    }
+};
+} // namespace
+
+namespace sky {
+template<>
+struct ResourceLoader<Blob> : FileLoader<Blob> {};
+} // sky
+
+namespace {
+unsigned long long sample(const char* data, size_t size) {
+    unsigned long long sum = 0;
+
+    for(size_t i = 0; i < size; i += 4096) {
+        sum += static_cast<unsigned char>(data[i]);
+    }
+
+    return sum;
+}
+
+struct Result {
+    double milliseconds;
+    unsigned long long checksum;
+    bool ok;
+};
+
+Result readArchive(const std::string& filename, const std::vector<std::string>& names) {
+    std::vector<char> buffer;
+    Result result{ 0, 0, true };
+    auto start = Clock::now();
+    sky::Archive archive;
+    result.ok = archive.openFromFile(filename);
+
+    for(size_t i = 0; i < names.size() && result.ok; ++i) {
+        auto entry = archive.find(names[i]);
+        const char* data = entry.view(buffer);
+        result.ok = data != nullptr;
+        result.checksum += result.ok ? sample(data, entry.getSize()) : 0;
+    }
+
+    result.milliseconds = millisecondsSince(start);
+    return result;
+}
+
+Result readLoose(const std::string& directory, const std::vector<std::string>& names) {
+    Result result{ 0, 0, true };
+    auto start = Clock::now();
+
+    std::vector<char> data;
+
+    for(size_t i = 0; i < names.size() && result.ok; ++i) {
+        result.ok = readFile(directory + "/" + names[i], data);
+        result.checksum += sample(data.data(), data.size());
+    }
+
+    result.milliseconds = millisecondsSince(start);
+    return result;
+}
+
+Result loadArchive(const std::string& filename, const std::vector<std::string>& names) {
+    sky::ResourceCache<std::string, Blob> cache;
+    Result result{ 0, 0, true };
+    auto start = Clock::now();
+    sky::Archive archive;
+    result.ok = archive.openFromFile(filename);
+
+    for(size_t i = 0; i < names.size() && result.ok; ++i) {
+        auto blob = cache.load(names[i], archive.find(names[i]));
+        result.ok = blob != nullptr;
+        result.checksum += result.ok ? sample(blob->bytes.data(), blob->bytes.size()) : 0;
+    }
+
+    result.milliseconds = millisecondsSince(start);
+    return result;
+}
+
+Result loadLoose(const std::string& directory, const std::vector<std::string>& names) {
+    sky::ResourceCache<std::string, Blob> cache;
+    Result result{ 0, 0, true };
+    auto start = Clock::now();
+
+    for(size_t i = 0; i < names.size() && result.ok; ++i) {
+        auto blob = cache.load(names[i], directory + "/" + names[i]);
+        result.ok = blob != nullptr;
+        result.checksum += result.ok ? sample(blob->bytes.data(), blob->bytes.size()) : 0;
+    }
+
+    result.milliseconds = millisecondsSince(start);
+    return result;
+}
+
+// Runs read once cold and once warm and prints both times. Returns the
+// checksum of the warm run, or 0 with ok cleared if either run failed.
+template<typename Read>
+Result measure(const char* name, const std::vector<std::string>& files, Read read) {
+    for(auto&& file : files) {
+        evict(file);
+    }
+
+    Result cold = read();
+    Result warm = read();
+    std::cout << name << ": " << cold.milliseconds << " ms cold, " << warm.milliseconds << " ms warm\n";
+    warm.ok = warm.ok && cold.ok && cold.checksum == warm.checksum;
+    return warm;
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if(argc < 2) {
+        std::cerr << "usage: archivebench archive.skya [directory]\n";
+        return 1;
+    }
+
+    std::string filename = argv[1];
+    std::vector<std::string> names;
+    unsigned long long bytes = 0;
+    size_t compressed = 0;
+    {
+        sky::Archive archive;
+
+        if(!archive.openFromFile(filename)) {
+            std::cerr << "could not open " << filename << '\n';
+            return 1;
+        }
+
+        names = archive.getNames();
+
+        for(auto&& name : names) {
+            auto entry = archive.find(name);
+            bytes += entry.getSize();
+            compressed += entry.isCompressed();
+        }
+    }
+
+    std::cout << names.size() << " entries (" << compressed << " compressed), " << bytes << " bytes\n";
+    std::vector<std::string> archived{ filename };
+    std::vector<std::string> loose;
+
+    if(argc > 2) {
+        for(auto&& name : names) {
+            loose.push_back(std::string(argv[2]) + "/" + name);
+        }
+    }
+
+    Result raw = measure("archive, raw read", archived, [&] { return readArchive(filename, names); });
+    Result cached = measure("archive, ResourceCache::load", archived, [&] { return loadArchive(filename, names); });
+
+    if(!raw.ok || !cached.ok || raw.checksum != cached.checksum) {
+        std::cerr << "corrupt archive\n";
+        return 1;
+    }
+
+    if(argc > 2) {
+        Result looseRaw = measure("loose files, raw read", loose, [&] { return readLoose(argv[2], names); });
+        Result looseCached = measure("loose files, ResourceCache::load", loose, [&] { return loadLoose(argv[2], names); });
+
+        if(!looseRaw.ok || !looseCached.ok || looseRaw.checksum != raw.checksum || looseCached.checksum != raw.checksum) {
+            std::cerr << "contents differ from the loose files\n";
+            return 1;
+        }
+    }
+
+    return 0;
+}
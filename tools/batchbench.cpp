@@ -0,0 +1,150 @@
+// The zlib/libpng License
+
+// Copyright (c) 2014 Danny Y., Rapptz
+
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+
+// Permission is granted to anyone to use this software for any purpose, including
+// commercial applications, and to alter it and redistribute it freely, subject to
+// the following restrictions:
+
+// 1. The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software. If you use this software in a product,
+// an acknowledgment in the product documentation would be appreciated but is
+// not required.
+
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+
+// 3. This notice may not be removed or altered from any source distribution.
+
+// Headless benchmark of drawing many AnimatedSprites one by one against
+// drawing them through a SpriteBatch, rendering into a RenderTexture.
+// Build with e.g. g++ -std=c++11 -O2 -pthread -I. tools/batchbench.cpp -o batchbench -lsfml-graphics -lsfml-window -lsfml-system
+//
+// usage: batchbench [sprites] [textures] [frames]
+// Without a display, run it with e.g. xvfb-run ./batchbench. Sprites are
+// sorted by texture before batching, so a frame takes one draw call per
+// texture. Drawing them one by one is timed both before and after sorting
+// to tell the gain from batching apart from the gain from fewer texture
+// switches. Frame times include building the batch and waiting for the GPU,
+// the time spent issuing draws is reported separately.
+
+#include <Sky/Concurrency/JobSystem.hpp>
+#include <Sky/Graphics/AnimatedSprite.hpp>
+#include <Sky/Graphics/Animation.hpp>
+#include <Sky/Graphics/RenderStats.hpp>
+#include <Sky/Graphics/SpriteBatch.hpp>
+#include <SFML/Graphics/RenderTexture.hpp>
+#include <SFML/Graphics/Texture.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+template<typename Callable>
+void measure(const char* name, sf::RenderTexture& target, sky::RenderStats& stats, unsigned frames, Callable&& draw) {
+    double total = 0;
+    double issuing = 0;
+    std::size_t draws = 0;
+
+    for(unsigned i = 0; i < frames; ++i) {
+        auto start = Clock::now();
+        stats.beginFrame();
+        target.clear();
+        draw();
+        issuing += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        target.display();
+
+        // Reading a pixel back waits for the GPU to finish the frame.
+        target.getTexture().copyToImage();
+        total += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        draws = stats.getCurrentFrame().getTotal().draws;
+        stats.endFrame();
+    }
+
+    std::cout << name << ": " << total / frames << " ms per frame (" << issuing / frames << " ms issuing draws), "
+              << draws << " draw calls\n";
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+    unsigned count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000;
+    unsigned textureCount = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 4;
+    unsigned frames = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 100;
+
+    sf::RenderTexture target;
+
+    if(count == 0 || textureCount == 0 || frames == 0) {
+        std::cerr << "usage: batchbench [sprites] [textures] [frames]\n";
+        return 1;
+    }
+
+    if(!target.create(1024, 768)) {
+        std::cerr << "could not create a RenderTexture\n";
+        return 1;
+    }
+
+    std::vector<sf::Texture> textures(textureCount);
+    std::vector<sky::Animation> animations;
+    animations.reserve(textureCount);
+
+    for(auto&& texture : textures) {
+        texture.create(64, 16);
+        animations.emplace_back(texture);
+        animations.back().addFrames(4, 0, 0, 16, 16);
+    }
+
+    std::vector<sky::AnimatedSprite> sprites;
+    sprites.reserve(count);
+
+    for(unsigned i = 0; i < count; ++i) {
+        sprites.emplace_back(animations[i % textureCount]);
+        sprites.back().setPosition(static_cast<float>(i * 7 % 1008), static_cast<float>(i * 13 % 752));
+    }
+
+    sky::RenderStats stats(0);
+    sky::RenderStats::setCurrent(&stats);
+
+    measure("AnimatedSprite::draw", target, stats, frames, [&] {
+        for(auto&& sprite : sprites) {
+            target.draw(sprite);
+        }
+    });
+
+    std::stable_sort(sprites.begin(), sprites.end(), [](const sky::AnimatedSprite& lhs, const sky::AnimatedSprite& rhs) {
+        return lhs.getTexture() < rhs.getTexture();
+    });
+
+    measure("AnimatedSprite::draw sorted by texture", target, stats, frames, [&] {
+        for(auto&& sprite : sprites) {
+            target.draw(sprite);
+        }
+    });
+
+    sky::SpriteBatch batch;
+    batch.reserve(count);
+
+    measure("SpriteBatch", target, stats, frames, [&] {
+        batch.clear();
+        batch.add(sprites.begin(), sprites.end());
+        target.draw(batch);
+    });
+
+    sky::JobSystem jobs;
+
+    measure("SpriteBatch filled on the job system", target, stats, frames, [&] {
+        batch.clear();
+        batch.add(sprites.begin(), sprites.end(), jobs);
+        target.draw(batch);
+    });
+
+    sky::RenderStats::setCurrent(nullptr);
+    return 0;
+}
@@ -0,0 +1,135 @@
+// The zlib/libpng License
+
+// Copyright (c) 2014 Danny Y., Rapptz
+
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+
+// Permission is granted to anyone to use this software for any purpose, including
+// commercial applications, and to alter it and redistribute it freely, subject to
+// the following restrictions:
+
+// 1. The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software. If you use this software in a product,
+// an acknowledgment in the product documentation would be appreciated but is
+// not required.
+
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+
+// 3. This notice may not be removed or altered from any source distribution.
+
+// Stress test and rough benchmark for sky::ConcurrentResourceCache.
+// Build with e.g. g++ -std=c++11 -O2 -pthread -I. tools/cachestress.cpp -o cachestress
+// and preferably once more with -fsanitize=thread or -fsanitize=address.
+//
+// usage: cachestress [readers] [seconds]
+// Readers look keys up while a writer keeps inserting and releasing them,
+// one at a time and in batches. Every resource holds its own key, so a
+// reader that sees a torn or reclaimed snapshot reports a mismatch.
+
+#include <Sky/Graphics/ConcurrentResourceCache.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+const unsigned keyCount = 1024;
+
+std::string keyName(unsigned index) {
+    return "resource/" + std::to_string(index);
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+    unsigned readers = argc > 1 ? static_cast<unsigned>(std::atoi(argv[1])) : 4;
+    int seconds = argc > 2 ? std::atoi(argv[2]) : 2;
+    sky::ConcurrentResourceCache<std::string, unsigned> cache;
+    std::vector<std::string> keys;
+
+    for(unsigned i = 0; i < keyCount; ++i) {
+        keys.push_back(keyName(i));
+    }
+
+    auto start = Clock::now();
+    cache.batch([&keys](sky::ConcurrentResourceCache<std::string, unsigned>::Batch& batch) {
+        for(unsigned i = 0; i < keyCount; ++i) {
+            batch.insert(keys[i], i);
+        }
+    });
+    std::cout << "batched insert of " << keyCount << " keys: "
+              << std::chrono::duration<double, std::milli>(Clock::now() - start).count() << " ms\n";
+
+    std::atomic<bool> running(true);
+    std::atomic<unsigned long long> lookups(0);
+    std::atomic<unsigned long long> mismatches(0);
+    std::vector<std::thread> threads;
+
+    for(unsigned t = 0; t < readers; ++t) {
+        threads.emplace_back([&, t] {
+            unsigned long long local = 0;
+            unsigned index = t;
+
+            while(running.load(std::memory_order_relaxed)) {
+                index = (index * 1103515245u + 12345u) % keyCount;
+                auto resource = cache.get(keys[index]);
+
+                if(resource && *resource != index) {
+                    mismatches.fetch_add(1);
+                }
+
+                cache.visit(keys[index], [&](const unsigned& value) {
+                    if(value != index) {
+                        mismatches.fetch_add(1);
+                    }
+                });
+
+                ++local;
+            }
+
+            lookups.fetch_add(local);
+        });
+    }
+
+    unsigned long long writes = 0;
+    auto deadline = Clock::now() + std::chrono::seconds(seconds);
+
+    for(unsigned i = 0; Clock::now() < deadline; ++i) {
+        unsigned index = i % keyCount;
+
+        if(i % 64 == 0) {
+            cache.batch([&](sky::ConcurrentResourceCache<std::string, unsigned>::Batch& batch) {
+                for(unsigned j = 0; j < 32; ++j) {
+                    unsigned other = (index + j) % keyCount;
+                    batch.release(keys[other]);
+                    batch.insert(keys[other], other);
+                }
+            });
+        }
+        else {
+            cache.release(keys[index]);
+            cache.insert(keys[index], index);
+        }
+
+        ++writes;
+    }
+
+    running.store(false);
+
+    for(auto&& thread : threads) {
+        thread.join();
+    }
+
+    bool ok = mismatches.load() == 0 && cache.size() == keyCount;
+    std::cout << readers << " readers: " << lookups.load() / seconds << " lookups/s, "
+              << writes / seconds << " write rounds/s, " << mismatches.load() << " mismatches\n"
+              << (ok ? "ok" : "FAILED") << '\n';
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,199 @@
+// The zlib/libpng License
+
+// Copyright (c) 2014 Danny Y., Rapptz
+
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+
+// Permission is granted to anyone to use this software for any purpose, including
+// commercial applications, and to alter it and redistribute it freely, subject to
+// the following restrictions:
+
+// 1. The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software. If you use this software in a product,
+// an acknowledgment in the product documentation would be appreciated but is
+// not required.
+
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+
+// 3. This notice may not be removed or altered from any source distribution.
+
+// Stress test and rough benchmark for sky::JobSystem.
+// Build with e.g. g++ -std=c++11 -O2 -pthread -I. tools/jobstress.cpp -o jobstress
+// and preferably once more with -fsanitize=thread.
+//
+// usage: jobstress [threads] [rounds]
+// Exits with a non-zero status if any job ran the wrong number of times.
+
+#include <Sky/Concurrency/JobSystem.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+bool check(bool condition, const char* what) {
+    if(!condition) {
+        std::cerr << "failed: " << what << '\n';
+    }
+
+    return condition;
+}
+
+// Many tiny independent jobs on one counter.
+bool independent(sky::JobSystem& jobs, unsigned count) {
+    std::atomic<unsigned> ran(0);
+    sky::JobCounter counter;
+    auto start = Clock::now();
+
+    for(unsigned i = 0; i < count; ++i) {
+        jobs.schedule([&ran] { ran.fetch_add(1, std::memory_order_relaxed); }, &counter);
+    }
+
+    jobs.wait(counter);
+    double elapsed = millisecondsSince(start);
+    std::cout << "  independent: " << count << " jobs in " << elapsed << " ms\n";
+    return check(ran.load() == count, "independent job count");
+}
+
+// Jobs that schedule more jobs from worker threads.
+bool nested(sky::JobSystem& jobs, unsigned fanout) {
+    std::atomic<unsigned> ran(0);
+    sky::JobCounter counter;
+    auto start = Clock::now();
+
+    for(unsigned i = 0; i < fanout; ++i) {
+        jobs.schedule([&jobs, &ran, &counter, fanout] {
+            for(unsigned j = 0; j < fanout; ++j) {
+                jobs.schedule([&ran] { ran.fetch_add(1, std::memory_order_relaxed); }, &counter);
+            }
+        }, &counter);
+    }
+
+    jobs.wait(counter);
+    std::cout << "  nested: " << fanout * fanout << " jobs in " << millisecondsSince(start) << " ms\n";
+    return check(ran.load() == fanout * fanout, "nested job count");
+}
+
+// A chain of dependencies where every stage must see the previous one finished.
+bool chained(sky::JobSystem& jobs, unsigned length) {
+    std::vector<std::unique_ptr<sky::JobCounter>> stages;
+    std::atomic<unsigned> reached(0);
+    std::atomic<bool> ordered(true);
+
+    for(unsigned i = 0; i < length; ++i) {
+        stages.emplace_back(new sky::JobCounter());
+    }
+
+    jobs.schedule([&reached] { reached.store(1); }, stages[0].get());
+
+    for(unsigned i = 1; i < length; ++i) {
+        jobs.scheduleAfter(*stages[i - 1], [&reached, &ordered, i] {
+            if(reached.load() != i) {
+                ordered.store(false);
+            }
+
+            reached.store(i + 1);
+        }, stages[i].get());
+    }
+
+    jobs.wait(*stages.back());
+    return check(ordered.load() && reached.load() == length, "dependency order");
+}
+
+// Fine grained work, once as JobSystem jobs and once through std::async,
+// which starts a thread for every task.
+bool versusAsync(sky::JobSystem& jobs, unsigned count) {
+    auto work = [](unsigned seed) {
+        unsigned value = seed;
+
+        for(unsigned i = 0; i < 64; ++i) {
+            value = value * 1664525u + 1013904223u;
+        }
+
+        return value;
+    };
+
+    std::vector<unsigned> results(count);
+    sky::JobCounter counter;
+    auto start = Clock::now();
+
+    for(unsigned i = 0; i < count; ++i) {
+        jobs.schedule([&results, &work, i] { results[i] = work(i); }, &counter);
+    }
+
+    jobs.wait(counter);
+    double pooled = millisecondsSince(start);
+    std::vector<std::future<unsigned>> futures;
+    futures.reserve(count);
+    start = Clock::now();
+
+    for(unsigned i = 0; i < count; ++i) {
+        futures.push_back(std::async(std::launch::async, work, i));
+    }
+
+    bool same = true;
+
+    for(unsigned i = 0; i < count; ++i) {
+        same = futures[i].get() == results[i] && same;
+    }
+
+    double async = millisecondsSince(start);
+    std::cout << "  " << count << " small jobs: JobSystem " << pooled << " ms, std::async " << async << " ms\n";
+    return check(same, "std::async comparison");
+}
+
+// parallelFor has to cover every index exactly once whatever the grain.
+bool ranges(sky::JobSystem& jobs, size_t size) {
+    std::vector<std::atomic<unsigned>> hits(size);
+    bool result = true;
+
+    for(size_t grain : { size_t(0), size_t(1), size_t(7), size + 1 }) {
+        for(auto&& hit : hits) {
+            hit.store(0);
+        }
+
+        auto start = Clock::now();
+        jobs.parallelFor(0, size, [&hits](size_t first, size_t last) {
+            for(size_t i = first; i < last; ++i) {
+                hits[i].fetch_add(1, std::memory_order_relaxed);
+            }
+        }, grain);
+
+        std::cout << "  parallelFor grain " << grain << ": " << millisecondsSince(start) << " ms\n";
+
+        for(auto&& hit : hits) {
+            result = result && hit.load() == 1;
+        }
+    }
+
+    return check(result, "parallelFor coverage");
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+    unsigned threads = argc > 1 ? static_cast<unsigned>(std::atoi(argv[1])) : sky::JobSystem::defaultThreadCount();
+    unsigned rounds = argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : 20;
+    bool ok = true;
+    sky::JobSystem jobs(threads);
+    std::cout << jobs.getWorkerCount() << " workers, " << rounds << " rounds\n";
+
+    for(unsigned round = 0; round < rounds && ok; ++round) {
+        std::cout << "round " << round << '\n';
+        ok = independent(jobs, 100000) && nested(jobs, 300) && chained(jobs, 1000) && ranges(jobs, 1 << 16) && versusAsync(jobs, 2000);
+    }
+
+    std::cout << (ok ? "ok" : "FAILED") << '\n';
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,87 @@
+// The zlib/libpng License
+
+// Copyright (c) 2014 Danny Y., Rapptz
+
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+
+// Permission is granted to anyone to use this software for any purpose, including
+// commercial applications, and to alter it and redistribute it freely, subject to
+// the following restrictions:
+
+// 1. The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software. If you use this software in a product,
+// an acknowledgment in the product documentation would be appreciated but is
+// not required.
+
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+
+// 3. This notice may not be removed or altered from any source distribution.
+
+// Rough benchmark of ResourceCache lookups against a plain
+// std::unordered_map<std::string, ...> keyed the usual way.
+// Build with e.g. g++ -std=c++11 -O2 -pthread -I. tools/lookupbench.cpp -o lookupbench -lsfml-graphics -lsfml-system
+//
+// usage: lookupbench [iterations]
+
+#include <Sky/Graphics/ResourceCache.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+template<typename Callable>
+void measure(const char* name, unsigned long iterations, Callable&& func) {
+    unsigned long sum = 0;
+    auto start = Clock::now();
+
+    for(unsigned long i = 0; i < iterations; ++i) {
+        sum += func();
+    }
+
+    double elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    std::cout << name << ": " << elapsed / iterations << " ns per lookup (" << sum << ")\n";
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+    unsigned long iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000000;
+    std::unordered_map<std::string, std::shared_ptr<int>> map;
+    sky::ResourceCache<std::string, int> cache;
+
+    for(int i = 0; i < 1000; ++i) {
+        std::string key = "textures/tiles/" + std::to_string(i) + ".png";
+        map.emplace(key, std::make_shared<int>(i));
+        cache.insert(key, i);
+    }
+
+    map.emplace("textures/player/idle.png", std::make_shared<int>(1));
+    cache.insert("textures/player/idle.png", 1);
+
+    measure("std::unordered_map with a std::string temporary", iterations, [&map] {
+        return *map.find("textures/player/idle.png")->second;
+    });
+
+    measure("ResourceCache::get with a literal", iterations, [&cache] {
+        return *cache.get("textures/player/idle.png");
+    });
+
+    constexpr sky::HashedString key("textures/player/idle.png");
+    measure("ResourceCache::get with a constexpr HashedString", iterations, [&cache, &key] {
+        return *cache.get(key);
+    });
+
+    auto handle = cache.handle(key);
+    measure("ResourceCache::resolve with a handle", iterations, [&cache, handle] {
+        return *cache.resolve(handle);
+    });
+
+    return 0;
+}
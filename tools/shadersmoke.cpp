@@ -0,0 +1,175 @@
+// The zlib/libpng License
+
+// Copyright (c) 2014 Danny Y., Rapptz
+
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+
+// Permission is granted to anyone to use this software for any purpose, including
+// commercial applications, and to alter it and redistribute it freely, subject to
+// the following restrictions:
+
+// 1. The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software. If you use this software in a product,
+// an acknowledgment in the product documentation would be appreciated but is
+// not required.
+
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+
+// 3. This notice may not be removed or altered from any source distribution.
+
+// Headless smoke test for sky::ShaderAnimationBatch. Draws a two frame
+// strip into a RenderTexture and checks that the expected frame shows up,
+// both right after add() and once the first frame's delay has passed.
+// Then it sweeps 64 instances with different offsets of a four frame strip
+// over 60 updates, looped and not, across the point where the 24 bit
+// start times wrap. Each pixel is checked against the frame the elapsed
+// time calls for. Pixels within 2 ms of a frame change are skipped,
+// because start times are stored in whole milliseconds.
+// Build with e.g. g++ -std=c++11 -I. tools/shadersmoke.cpp -o shadersmoke -lsfml-graphics -lsfml-window -lsfml-system
+//
+// usage: shadersmoke
+// Without a display, run it on Mesa's software rasterizer with e.g.
+// LIBGL_ALWAYS_SOFTWARE=1 xvfb-run ./shadersmoke
+// Exits with 0 on success, 1 on a wrong frame and 2 if no RenderTexture
+// could be created. It reports whether the shader or the CPU fallback ran.
+
+#include <Sky/Graphics/Animation.hpp>
+#include <Sky/Graphics/ShaderAnimation.hpp>
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/RenderTexture.hpp>
+#include <SFML/Graphics/Texture.hpp>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+
+namespace {
+bool expect(sf::RenderTexture& target, const sky::ShaderAnimationBatch& batch, const sf::Color& colour, const char* when) {
+    target.clear(sf::Color::Black);
+    target.draw(batch);
+    target.display();
+
+    sf::Color pixel = target.getTexture().copyToImage().getPixel(2, 2);
+
+    if(pixel != colour) {
+        std::cerr << when << ": expected (" << +colour.r << ", " << +colour.g << ", " << +colour.b << ") but got ("
+                  << +pixel.r << ", " << +pixel.g << ", " << +pixel.b << ")\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool sweep(sf::RenderTexture& target, bool looped) {
+    const sf::Color colours[] = { sf::Color::Red, sf::Color::Green, sf::Color::Blue, sf::Color::White };
+    const unsigned frameCount = 4;
+    const std::int64_t delay = 16667;
+    sf::Image image;
+    image.create(4 * frameCount, 4);
+
+    for(unsigned frame = 0; frame < frameCount; ++frame) {
+        for(unsigned y = 0; y < 4; ++y) {
+            for(unsigned x = 0; x < 4; ++x) {
+                image.setPixel(frame * 4 + x, y, colours[frame]);
+            }
+        }
+    }
+
+    sf::Texture texture;
+    texture.loadFromImage(image);
+    sky::Animation animation(texture);
+    animation.addFrames(frameCount, 0, 0, 4, 4);
+
+    sky::ShaderAnimationBatch batch;
+    batch.setAnimation(animation, sf::microseconds(delay), looped);
+
+    // 216 ms before the 24 bit millisecond clock wraps.
+    batch.update(sf::seconds(16777.f));
+    std::int64_t elapsed = 0;
+
+    for(unsigned i = 0; i < 64; ++i) {
+        sf::Transform transform;
+        transform.translate((i % 8) * 8.f, (i / 8) * 8.f);
+        batch.add(transform, sf::microseconds(i * 5300));
+    }
+
+    unsigned checked = 0;
+    unsigned wrong = 0;
+
+    for(unsigned step = 0; step < 60; ++step) {
+        batch.update(sf::microseconds(4100));
+        elapsed += 4100;
+        target.clear(sf::Color::Black);
+        target.draw(batch);
+        target.display();
+        sf::Image output = target.getTexture().copyToImage();
+
+        for(unsigned i = 0; i < 64; ++i) {
+            std::int64_t age = elapsed + i * 5300;
+            std::int64_t sinceChange = age % delay;
+
+            if(sinceChange < 2000 || delay - sinceChange < 2000) {
+                continue;
+            }
+
+            unsigned frame = static_cast<unsigned>(age / delay);
+            frame = frame < frameCount ? frame : looped ? frame % frameCount : 0;
+            ++checked;
+
+            if(output.getPixel((i % 8) * 8 + 2, (i / 8) * 8 + 2) != colours[frame]) {
+                ++wrong;
+            }
+        }
+    }
+
+    std::cout << (looped ? "looped" : "not looped") << ": " << checked << " pixels checked, " << wrong << " wrong\n";
+    return wrong == 0;
+}
+} // namespace
+
+int main() {
+    // Frame 0 is red, frame 1 is green.
+    sf::Image image;
+    image.create(8, 4, sf::Color::Red);
+
+    for(unsigned y = 0; y < 4; ++y) {
+        for(unsigned x = 4; x < 8; ++x) {
+            image.setPixel(x, y, sf::Color::Green);
+        }
+    }
+
+    sf::RenderTexture target;
+    sf::Texture texture;
+
+    if(!target.create(16, 16) || !texture.loadFromImage(image)) {
+        std::cerr << "could not create a RenderTexture\n";
+        return 2;
+    }
+
+    sky::Animation animation(texture);
+    animation.addFrames(2, 0, 0, 4, 4);
+
+    sky::ShaderAnimationBatch batch;
+    batch.setAnimation(animation, sf::milliseconds(100));
+    batch.add(sf::Transform::Identity);
+    std::cout << (batch.isUsingShader() ? "shader" : "fallback") << " path\n";
+
+    if(!expect(target, batch, sf::Color::Red, "after add")) {
+        return 1;
+    }
+
+    batch.update(sf::milliseconds(150));
+
+    if(!expect(target, batch, sf::Color::Green, "after 150 ms")) {
+        return 1;
+    }
+
+    if(!target.create(64, 64) || !sweep(target, true) || !sweep(target, false)) {
+        return 1;
+    }
+
+    std::cout << "ok\n";
+    return 0;
+}
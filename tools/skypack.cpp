@@ -0,0 +1,63 @@
+// The zlib/libpng License
+
+// Copyright (c) 2014 Danny Y., Rapptz
+
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+
+// Permission is granted to anyone to use this software for any purpose, including
+// commercial applications, and to alter it and redistribute it freely, subject to
+// the following restrictions:
+
+// 1. The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software. If you use this software in a product,
+// an acknowledgment in the product documentation would be appreciated but is
+// not required.
+
+// 2. Altered source versions must be plainly marked as such, and must not be
+// misrepresented as being the original software.
+
+// 3. This notice may not be removed or altered from any source distribution.
+
+// Packs files into a .skya archive for sky::Archive.
+// Build with e.g. g++ -std=c++11 -I. tools/skypack.cpp -o skypack
+//
+// usage: skypack [--store] output.skya file...
+// Entries are named by the path given on the command line.
+
+#include <Sky/Utility/Archive.hpp>
+#include <cstring>
+#include <iostream>
+
+int main(int argc, char* argv[]) {
+    int index = 1;
+    bool compress = true;
+
+    if(index < argc && std::strcmp(argv[index], "--store") == 0) {
+        compress = false;
+        ++index;
+    }
+
+    if(argc - index < 2) {
+        std::cerr << "usage: " << argv[0] << " [--store] output.skya file...\n";
+        return 1;
+    }
+
+    std::string output = argv[index++];
+    sky::ArchiveWriter writer;
+
+    for(; index < argc; ++index) {
+        if(!writer.addFile(argv[index], argv[index])) {
+            std::cerr << "could not read " << argv[index] << '\n';
+            return 1;
+        }
+    }
+
+    if(!writer.saveToFile(output, compress)) {
+        std::cerr << "could not write " << output << '\n';
+        return 1;
+    }
+
+    std::cout << "packed " << writer.getFileCount() << " files into " << output << '\n';
+}